@@ -33,20 +33,7 @@
 #include "gameio.h"
 #include <stdio.h>
 #include <string.h>
-
-//----------------------------------------------------------------------------
-class ARegionFlatArray
-{
-public:
-	ARegionFlatArray(int);
-	~ARegionFlatArray();
-
-	void SetRegion(int, ARegion *);
-	ARegion* GetRegion(int);
-
-	int size;
-	ARegion **regions;
-};
+#include <algorithm>
 
 //----------------------------------------------------------------------------
 Product::Product(int p, int c, int a)
@@ -242,6 +229,7 @@ ARegion::ARegion()
 	town = NULL;
 	clearskies = 0;
 	earthlore = 0;
+	battlesFought = 0;
 
 	type = -1;
 	race = -1;
@@ -2137,9 +2125,10 @@ void ARegion::WriteExits(Areport *f, ARegionList *pRegs, bool *exits_seen) const
 
 void ARegion::WriteReport(Areport *f, Faction *fac, int month, ARegionList *pRegions)
 {
-	Farsight *farsight = GetFarsight(&farsees, fac);
-	Farsight *passer = GetFarsight(&passers, fac);
-	const int present = Present(fac) || fac->IsNPC();
+	const RegionVision &vis = GetVision(fac);
+	const bool farsight = vis.farsight;
+	const bool passer = vis.passer;
+	const bool present = vis.present || fac->IsNPC();
 
 	if (!farsight && !passer && !present)
 		return; // can't see anything
@@ -2243,53 +2232,8 @@ void ARegion::WriteReport(Areport *f, Faction *fac, int month, ARegionList *pReg
 
 	if (Globals->GATES_EXIST && gate && gate != -1)
 	{
-		bool sawgate = false;
-		if (fac->IsNPC())
-			sawgate = true; // NPCs see everything
-
-		if (Globals->IMPROVED_FARSIGHT && farsight)
-		{
-			forlist(&farsees)
-			{
-				Farsight *watcher = (Farsight*)elem;
-				if (watcher && watcher->faction == fac && watcher->unit)
-				{
-					if (watcher->unit->GetSkill(S_GATE_LORE))
-					{
-						sawgate = true;
-					}
-				}
-			}
-		}
-
-		if (Globals->TRANSIT_REPORT & GameDefs::REPORT_USE_UNIT_SKILLS)
-		{
-			forlist(&passers)
-			{
-				Farsight *watcher = (Farsight*)elem;
-				if (watcher && watcher->faction == fac && watcher->unit)
-				{
-					if (watcher->unit->GetSkill(S_GATE_LORE))
-					{
-						sawgate = true;
-					}
-				}
-			}
-		}
-
-		forlist(&objects)
-		{
-			Object *o = (Object*)elem;
-			for(auto &u : o->getUnits())
-			{
-				if (!sawgate && (u->faction == fac && u->GetSkill(S_GATE_LORE)))
-				{
-					sawgate = true;
-				}
-			}
-		}
-
-		if (sawgate)
+		// NPCs see everything
+		if (vis.sawgate || fac->IsNPC())
 		{
 			f->PutStr(AString("There is a Gate here (Gate ") + gate +
 				 " of " + (pRegions->numberofgates) + ").");
@@ -2297,61 +2241,13 @@ void ARegion::WriteReport(Areport *f, Faction *fac, int month, ARegionList *pReg
 		}
 	}
 
-	int detfac = 0; // detect faction
-
-	forlist(&objects)
-	{
-		Object *o = (Object*)elem;
-		for(auto &u : o->getUnits())
-		{
-			if (u->faction == fac && u->GetSkill(S_MIND_READING) > 2)
-			{
-				detfac = 1;
-			}
-		}
-	}
-
-	if (Globals->IMPROVED_FARSIGHT && farsight)
-	{
-		forlist(&farsees)
-		{
-			Farsight *watcher = (Farsight*)elem;
-			if (watcher && watcher->faction == fac && watcher->unit)
-			{
-				if (watcher->unit->GetSkill(S_MIND_READING) > 2)
-				{
-					detfac = 1;
-				}
-			}
-		}
-	}
-
-	int passdetfac = 0; // detect faction when passing through
-	if ((Globals->TRANSIT_REPORT & GameDefs::REPORT_USE_UNIT_SKILLS) &&
-		 (Globals->TRANSIT_REPORT & GameDefs::REPORT_SHOW_UNITS))
-	{
-		forlist(&passers)
-		{
-			Farsight *watcher = (Farsight*)elem;
-			if (watcher && watcher->faction == fac && watcher->unit)
-			{
-				if (watcher->unit->GetSkill(S_MIND_READING) > 2)
-				{
-					passdetfac = 1;
-				}
-			}
-		}
-	}
-
 	{ // protect macro
-		const int obs     = fac->IsNPC() ? 10 : GetObservation(fac, 0);
-		const int passobs = fac->IsNPC() ? 10 : GetObservation(fac, 1);
-		const int truesight = GetTrueSight(fac, 0);
-		const int passtrue  = GetTrueSight(fac, 1);
+		const int obs     = fac->IsNPC() ? 10 : vis.obs;
+		const int passobs = fac->IsNPC() ? 10 : vis.passobs;
 		forlist(&objects)
 		{
-			((Object*)elem)->Report(f, fac, obs, truesight, detfac,
-				 passobs, passtrue, passdetfac, present || farsight);
+			((Object*)elem)->Report(f, fac, obs, vis.truesight, vis.detfac,
+				 passobs, vis.passtrue, vis.passdetfac, present || farsight);
 		}
 	}
 
@@ -2451,100 +2347,106 @@ void ARegion::WriteTemplate(Areport *f, Faction *fac, ARegionList *pRegs, int mo
 	}
 }
 
-int ARegion::GetTrueSight(Faction *f, int usepassers)
+void ARegion::SetupVision()
 {
-	int truesight = 0;
+	vision.clear();
 
-	if (Globals->IMPROVED_FARSIGHT)
+	// entry for 'fac', added on first sight
+	auto visionFor = [this](const Faction *fac) -> RegionVision&
 	{
-		forlist(&farsees)
+		if (!vision.empty() && vision.back().faction == fac->num)
+			return vision.back(); // units of a faction are usually together
+
+		for (auto &v : vision)
 		{
-			Farsight *farsight = (Farsight*)elem;
-			if (farsight && farsight->faction == f && farsight->unit)
-			{
-				const int t = farsight->unit->GetSkill(S_TRUE_SEEING);
-				if (t > truesight) truesight = t;
-			}
+			if (v.faction == fac->num)
+				return v;
 		}
-	}
 
-	if (usepassers &&
+		vision.emplace_back();
+		vision.back().faction = fac->num;
+		return vision.back();
+	};
+
+	const bool usePassers =
 	    (Globals->TRANSIT_REPORT & GameDefs::REPORT_USE_UNIT_SKILLS) &&
-	    (Globals->TRANSIT_REPORT & GameDefs::REPORT_SHOW_UNITS))
-	{
-		forlist(&passers)
-		{
-			Farsight *farsight = (Farsight*)elem;
-			if (farsight && farsight->faction == f && farsight->unit)
-			{
-				const int t = farsight->unit->GetSkill(S_TRUE_SEEING);
-				if (t > truesight) truesight = t;
-			}
-		}
-	}
+	    (Globals->TRANSIT_REPORT & GameDefs::REPORT_SHOW_UNITS);
 
-	forlist((&objects))
+	forlist(&farsees)
 	{
-		Object *obj = (Object*)elem;
-		for(auto &u : obj->getUnits())
-		{
-			if (u->faction == f)
-			{
-				const int temp = u->GetSkill(S_TRUE_SEEING);
-				if (temp > truesight) truesight = temp;
-			}
-		}
-	}
+		Farsight *watcher = (Farsight*)elem;
+		RegionVision &v = visionFor(watcher->faction);
+		v.farsight = true;
 
-	return truesight;
-}
+		if (!Globals->IMPROVED_FARSIGHT || !watcher->unit)
+			continue;
 
-int ARegion::GetObservation(Faction *f, int usepassers)
-{
-	int obs = 0;
+		v.obs = std::max(v.obs, watcher->unit->GetSkill(S_OBSERVATION));
+		v.truesight = std::max(v.truesight, watcher->unit->GetSkill(S_TRUE_SEEING));
+		if (watcher->unit->GetSkill(S_MIND_READING) > 2)
+			v.detfac = true;
+		if (watcher->unit->GetSkill(S_GATE_LORE))
+			v.sawgate = true;
+	}
 
-	if (Globals->IMPROVED_FARSIGHT)
+	{ // protect macro
+	forlist(&passers)
 	{
-		forlist(&farsees)
+		Farsight *watcher = (Farsight*)elem;
+		RegionVision &v = visionFor(watcher->faction);
+		v.passer = true;
+
+		if (!watcher->unit)
+			continue;
+
+		if (usePassers)
 		{
-			Farsight *farsight = (Farsight*)elem;
-			if (farsight && farsight->faction == f && farsight->unit)
-			{
-				const int o = farsight->unit->GetSkill(S_OBSERVATION);
-				if (o > obs) obs = o;
-			}
+			v.passobs = std::max(v.passobs, watcher->unit->GetSkill(S_OBSERVATION));
+			v.passtrue = std::max(v.passtrue, watcher->unit->GetSkill(S_TRUE_SEEING));
+			if (watcher->unit->GetSkill(S_MIND_READING) > 2)
+				v.passdetfac = true;
 		}
+
+		if ((Globals->TRANSIT_REPORT & GameDefs::REPORT_USE_UNIT_SKILLS) &&
+		    watcher->unit->GetSkill(S_GATE_LORE))
+			v.sawgate = true;
+	}
 	}
 
-	if (usepassers &&
-	    (Globals->TRANSIT_REPORT & GameDefs::REPORT_USE_UNIT_SKILLS) &&
-	    (Globals->TRANSIT_REPORT & GameDefs::REPORT_SHOW_UNITS))
+	applyToUnits([&visionFor](Unit *u)
 	{
-		forlist(&passers)
-		{
-			Farsight *farsight = (Farsight*)elem;
-			if (farsight && farsight->faction == f && farsight->unit)
-			{
-				const int o = farsight->unit->GetSkill(S_OBSERVATION);
-				if (o > obs) obs = o;
-			}
-		}
+		RegionVision &v = visionFor(u->faction);
+		v.present = true;
+		v.obs = std::max(v.obs, u->GetSkill(S_OBSERVATION));
+		v.truesight = std::max(v.truesight, u->GetSkill(S_TRUE_SEEING));
+		if (u->GetSkill(S_MIND_READING) > 2)
+			v.detfac = true;
+		if (u->GetSkill(S_GATE_LORE))
+			v.sawgate = true;
 	}
+	);
 
-	forlist((&objects))
+	// passers add to what is seen directly
+	for (auto &v : vision)
 	{
-		Object *obj = (Object*)elem;
-		for(auto &u : obj->getUnits())
-		{
-			if (u->faction == f)
-			{
-				const int temp = u->GetSkill(S_OBSERVATION);
-				if (temp > obs) obs = temp;
-			}
-		}
+		v.passobs = std::max(v.passobs, v.obs);
+		v.passtrue = std::max(v.passtrue, v.truesight);
 	}
 
-	return obs;
+	std::sort(vision.begin(), vision.end(),
+	    [](const RegionVision &a, const RegionVision &b) { return a.faction < b.faction; });
+}
+
+const RegionVision& ARegion::GetVision(const Faction *f) const
+{
+	static const RegionVision none;
+
+	auto i = std::lower_bound(vision.begin(), vision.end(), f->num,
+	    [](const RegionVision &v, int num) { return v.faction < num; });
+	if (i == vision.end() || i->faction != f->num)
+		return none; // nothing here
+
+	return *i;
 }
 
 void ARegion::SetWeather(int newWeather)
@@ -2948,15 +2850,14 @@ int ARegionList::ReadRegions(Ainfile *f, AList *factions, ATL_VER v)
 
 	numberofgates = f->GetInt();
 
-	ARegionFlatArray fa(num);
+	regionIndex_.reserve(num);
 
 	Awrite("Reading the regions...");
 	for (int i = 0; i < num; ++i)
 	{
 		ARegion *temp = new ARegion;
 		temp->Readin(f, factions, v);
-		fa.SetRegion(temp->num, temp);
-		Add(temp);
+		AddRegion(temp);
 
 		pRegionArrays[ temp->zloc ]->SetRegion(temp->xloc, temp->yloc, temp);
 	}
@@ -2973,7 +2874,7 @@ int ARegionList::ReadRegions(Ainfile *f, AList *factions, ATL_VER v)
 				const int j = f->GetInt();
 				if (j != -1)
 				{
-					reg->neighbors[i] = fa.GetRegion(j);
+					reg->neighbors[i] = GetRegion(j);
 				}
 				else
 				{
@@ -2987,12 +2888,23 @@ int ARegionList::ReadRegions(Ainfile *f, AList *factions, ATL_VER v)
 
 ARegion* ARegionList::GetRegion(int n)
 {
-	forlist(this)
-	{
-		if (((ARegion*)elem)->num == n)
-			return (ARegion*)elem;
-	}
-	return NULL;
+	if (n < 0 || unsigned(n) >= regionIndex_.size())
+		return NULL;
+
+	return regionIndex_[n];
+}
+
+void ARegionList::AddRegion(ARegion *reg)
+{
+	Add(reg);
+
+	if (reg->num < 0)
+		return;
+
+	if (unsigned(reg->num) >= regionIndex_.size())
+		regionIndex_.resize(reg->num + 1, NULL);
+
+	regionIndex_[reg->num] = reg;
 }
 
 ARegion* ARegionList::GetRegion(int x, int y, int z)
@@ -3008,30 +2920,6 @@ ARegion* ARegionList::GetRegion(int x, int y, int z)
 	return arr->GetRegion(x, y);
 }
 
-Location* ARegionList::FindUnit(int i)
-{
-	forlist(this)
-	{
-		ARegion *reg = (ARegion*)elem;
-		forlist((&reg->objects))
-		{
-			Object *obj = (Object*)elem;
-			for(auto &u : obj->getUnits())
-			{
-				if (u->num == i)
-				{
-					Location *retval = new Location;
-					retval->unit = u;
-					retval->region = reg;
-					retval->obj = obj;
-					return retval;
-				}
-			}
-		}
-	}
-	return NULL;
-}
-
 void ARegionList::NeighSetup(ARegion *r, ARegionArray *ar)
 {
 	r->ZeroNeighbors();
@@ -3264,7 +3152,7 @@ void ARegionList::MakeRegions(int level, int xSize, int ySize)
 			reg->SetLoc(x, y, level);
 			reg->num = Num();
 
-			Add(reg);
+			AddRegion(reg);
 			arr->SetRegion(x, y, reg);
 		}
 	}
@@ -4276,26 +4164,3 @@ void ARegionArray::SetName(const char *name)
 		strName = NULL;
 	}
 }
-
-//----------------------------------------------------------------------------
-ARegionFlatArray::ARegionFlatArray(int s)
-{
-	size = s;
-	regions = new ARegion*[s];
-}
-
-ARegionFlatArray::~ARegionFlatArray()
-{
-	delete[] regions;
-}
-
-void ARegionFlatArray::SetRegion(int x, ARegion *r)
-{
-	regions[x] = r;
-}
-
-ARegion* ARegionFlatArray::GetRegion(int x)
-{
-	return regions[x];
-}
-
@@ -153,6 +153,22 @@ public:
 ///@return the farsight report for 'fac', or NULL
 Farsight* GetFarsight(AList *farsight_list, Faction *fac);
 
+/// what one faction can see in a region (gathered once before writing reports)
+struct RegionVision
+{
+	int faction = 0; ///< faction number
+	bool farsight = false; ///< has a farsight report here
+	bool passer = false; ///< passed through
+	bool present = false; ///< has units here
+	int obs = 0; ///< best observation of units and farsight
+	int passobs = 0; ///< best observation, including passers
+	int truesight = 0; ///< best true seeing of units and farsight
+	int passtrue = 0; ///< best true seeing, including passers
+	bool detfac = false; ///< can detect factions (mind reading 3)
+	bool passdetfac = false; ///< passers can detect factions
+	bool sawgate = false; ///< something knows gate lore
+};
+
 //----------------------------------------------------------------------------
 enum
 {
@@ -240,8 +256,11 @@ public:
 	///@return new list of FactionPtr containing all the factions represented here
 	AList* PresentFactions();
 
-	int GetObservation(Faction *f, int use_passers);
-	int GetTrueSight(Faction *f, int use_passers);
+	/// gather what each faction can see here, for WriteReport
+	void SetupVision();
+
+	///@return what 'f' can see here (as of the last SetupVision)
+	const RegionVision& GetVision(const Faction *f) const;
 
 	///@return object 'num', or NULL
 	Object* GetObject(int num);
@@ -374,6 +393,8 @@ public: // data
 	int clearskies;
 	int earthlore;
 
+	int battlesFought; ///< this turn (numbers the battles' random streams)
+
 	ARegion *neighbors[NDIRS];
 	AList objects;
 	AList hell; // Where dead units go
@@ -382,6 +403,8 @@ public: // data
 	// List of units which passed through the region
 	AList passers;
 
+	std::vector<RegionVision> vision; ///< by faction number
+
 	ProductionList products;
 	MarketList markets;
 	int xloc, yloc, zloc;
@@ -427,7 +450,6 @@ public:
 
 	ARegion* GetRegion(int region_num);
 	ARegion* GetRegion(int x, int y, int z);
-	Location* FindUnit(int unit_num);
 
 	void ChangeStartingCity(ARegion *, int);
 	ARegion* GetStartingCity(ARegion *AC, int num, int level, int maxX, int maxY);
@@ -491,6 +513,12 @@ private: // Private world creation stuff
 	// Game-specific world stuff (see world.cpp)
 	int GetRegType(ARegion *pReg);
 	int CheckRegionExit(ARegion *pFrom, ARegion *pTo);
+
+	/// add 'reg' to the list and the number index
+	void AddRegion(ARegion *reg);
+
+private: // data
+	std::vector<ARegion*> regionIndex_; ///< regions by number
 };
 
 //----------------------------------------------------------------------------
@@ -25,12 +25,14 @@
 #include "army.h"
 #include "aregion.h"
 #include "battle.h"
+#include "cohort.h"
 #include "faction.h"
 #include "gameio.h"
 #include "gamedata.h"
 #include "gamedefs.h"
 #include "object.h"
 #include "unit.h"
+#include <algorithm>
 #include <cstdlib>
 
 //----------------------------------------------------------------------------
@@ -44,9 +46,10 @@ int pow(int b, int p)
 	return b2;
 }
 
-int Hits(int a, int d)
+void HitOdds(int a, int d, int &tohit, int &tomiss)
 {
-	int tohit = 1, tomiss = 1;
+	tohit = 1;
+	tomiss = 1;
 
 	if (Globals->LINEAR_COMBAT) {
 		tohit = a;
@@ -75,6 +78,12 @@ int Hits(int a, int d)
 			tomiss = pow(2, d - a);
 		}
 	}
+}
+
+int Hits(int a, int d)
+{
+	int tohit, tomiss;
+	HitOdds(a, d, tohit, tomiss);
 
 	return (getrandom(tohit+tomiss) < tohit) ? 1 : 0;
 }
@@ -87,10 +96,48 @@ enum
 	LOSS
 };
 
-Soldier::Soldier(Unit *u, Object *o, int regtype, int r, int ass)
+namespace
+{
+/// add 'index' to the ascending 'list', if it is a real kind (1 to num-1)
+void AddKind(std::vector<int> &list, int index, int num)
 {
+	if (index <= 0 || index >= num)
+		return;
+
+	auto i = std::lower_bound(list.begin(), list.end(), index);
+	if (i == list.end() || *i != index)
+		list.insert(i, index);
+}
+}
+
+SoldierKit::SoldierKit(Unit *u)
+{
+	forlist(&u->items)
+	{
+		const Item *it = (Item*)elem;
+		if (!it->num)
+			continue;
+
+		const ItemType &def = ItemDefs[it->type];
+		if (def.type & IT_WEAPON)
+			AddKind(weapons, def.index, NUMWEAPONS);
+		if (def.type & IT_ARMOR)
+			AddKind(armors, def.index, NUMARMORS);
+		if (def.type & IT_MOUNT)
+			AddKind(mounts, def.index, NUMMOUNTS);
+		if (def.type & IT_BATTLE)
+			AddKind(battleItems, def.battleindex, NUMBATTLEITEMS);
+	}
+}
+
+//----------------------------------------------------------------------------
+Soldier::Soldier(Unit *u, Object *o, int regtype, int r,
+      const AString *nm, const SoldierKit &kit, int ass)
+{
+	name = nm;
 	race = r;
 	unit = u;
+	army = NULL;
 	building = 0;
 
 	healing = 0;
@@ -157,11 +204,6 @@ Soldier::Soldier(Unit *u, Object *o, int regtype, int r, int ass)
 		const int mon = ItemDefs[r].index;
 		const MonType &mon_def = MonDefs[mon];
 
-		if (u->type == U_WMON)
-			name = AString(mon_def.name) + " in " + *(unit->name);
-		else
-			name = AString(mon_def.name) + AString(" controlled by ") + *(unit->name);
-
 		askill = mon_def.attackLevel;
 
 		dskill[ATTACK_COMBAT] += mon_def.defense[ATTACK_COMBAT];
@@ -203,12 +245,10 @@ Soldier::Soldier(Unit *u, Object *o, int regtype, int r, int ass)
 		return;
 	}
 
-	name = *(unit->name);
-
 	SetupHealing();
 
 	SetupSpell();
-	SetupCombatItems();
+	SetupCombatItems(kit);
 
 	// set up armor
 	int i;
@@ -231,7 +271,7 @@ Soldier::Soldier(Unit *u, Object *o, int regtype, int r, int ass)
 	// look for a default armor
 	if (armor == -1)
 	{
-		for (int armorType = 1; armorType < NUMARMORS; ++armorType)
+		for (int armorType : kit.armors)
 		{
 			const int item = unit->GetArmor(armorType, ass);
 			if (item != -1)
@@ -250,7 +290,7 @@ Soldier::Soldier(Unit *u, Object *o, int regtype, int r, int ass)
 	if (canFly || canRide)
 	{
 		// mounts of some type _are_ allowed in this region
-		for (int mountType = 1; mountType < NUMMOUNTS; ++mountType)
+		for (int mountType : kit.mounts)
 		{
 			const int item = unit->GetMount(mountType, canFly, canRide, ridingBonus);
 			if (item == -1)
@@ -289,7 +329,7 @@ Soldier::Soldier(Unit *u, Object *o, int regtype, int r, int ass)
 	//--- equip a default weapon
 	if (weapon == -1)
 	{
-		for (int weaponType = 1; weaponType < NUMWEAPONS; ++weaponType)
+		for (int weaponType : kit.weapons)
 		{
 			const int item = unit->GetWeapon(weaponType, riding, ridingBonus, attackBonus, defenseBonus, numAttacks);
 			if (item != -1)
@@ -362,9 +402,9 @@ void Soldier::SetupSpell()
 	unit->Practise(unit->combat);
 }
 
-void Soldier::SetupCombatItems()
+void Soldier::SetupCombatItems(const SoldierKit &kit)
 {
-	for (int battleType = 1; battleType < NUMBATTLEITEMS; ++battleType)
+	for (int battleType : kit.battleItems)
 	{
 		const BattleItemType *const pBat = &BattleItemDefs[ battleType ];
 
@@ -486,6 +526,9 @@ void Soldier::SetEffect(int eff)
 
 		effects |= n;
 	}
+
+	if (army)
+		army->EffectsChanged(this);
 }
 
 void Soldier::ClearEffect(int eff)
@@ -506,6 +549,9 @@ void Soldier::ClearEffect(int eff)
 
 	const int n = 1 << eff;
 	effects &= ~n;
+
+	if (army)
+		army->EffectsChanged(this);
 }
 
 void Soldier::ClearOneTimeEffects()
@@ -517,7 +563,7 @@ void Soldier::ClearOneTimeEffects()
 	}
 }
 
-int Soldier::ArmorProtect(int weaponClass) const
+int Soldier::ArmorChance(int weaponClass, int &from) const
 {
 	int armorType = ARMOR_NONE;
 	if (armor > 0)
@@ -526,11 +572,18 @@ int Soldier::ArmorProtect(int weaponClass) const
 		armorType = ARMOR_NONE;
 
 	const ArmorType *const pArm = &ArmorDefs[armorType];
-	const int chance = pArm->saves[weaponClass];
+	from = pArm->from;
+	return pArm->saves[weaponClass];
+}
+
+int Soldier::ArmorProtect(int weaponClass) const
+{
+	int from;
+	const int chance = ArmorChance(weaponClass, from);
 	if (chance <= 0)
 		return 0;
 
-	return (chance > getrandom(pArm->from)) ? 1 : 0;
+	return (chance > getrandom(from)) ? 1 : 0;
 }
 
 void Soldier::RestoreItems()
@@ -605,6 +658,54 @@ void Soldier::Dead()
 	unit->SetMen(race, unit->GetMen(race) - 1);
 }
 
+//----------------------------------------------------------------------------
+TargetIndex::TargetIndex(int sp, int eff, int size)
+	: special(sp)
+	, effect(eff)
+	, in_(size, 0)
+	, tree_(size + 1, 0)
+{
+}
+
+void TargetIndex::Set(int pos, bool in)
+{
+	if (in_[pos] == in)
+		return;
+
+	in_[pos] = in;
+	const int delta = in ? 1 : -1;
+	for (int i = pos + 1; i < (int)tree_.size(); i += i & -i)
+		tree_[i] += delta;
+}
+
+int TargetIndex::Count(int end) const
+{
+	int n = 0;
+	for (int i = end; i > 0; i -= i & -i)
+		n += tree_[i];
+
+	return n;
+}
+
+int TargetIndex::Find(int n) const
+{
+	// walk down the tree, keeping the last position with n or fewer before it
+	int pos = 0;
+	int step = 1;
+	while (step * 2 < (int)tree_.size())
+		step *= 2;
+
+	for (; step; step /= 2)
+	{
+		if (pos + step < (int)tree_.size() && tree_[pos + step] <= n)
+		{
+			pos += step;
+			n -= tree_[pos];
+		}
+	}
+	return pos;
+}
+
 //----------------------------------------------------------------------------
 Army::Army(Unit *ldr, AList *locs, int regtype, int ass)
 {
@@ -618,6 +719,7 @@ Army::Army(Unit *ldr, AList *locs, int regtype, int ass)
 	Unit *tactitian = ldr;
 
 	leader = ldr;
+	cohorts = NULL;
 	round = 0;
 	tac = ldr->GetSkill(S_TACTICS);
 	count = 0;
@@ -645,6 +747,8 @@ Army::Army(Unit *ldr, AList *locs, int regtype, int ass)
 	}
 	tactitian->Practise(S_TACTICS);
 
+	// all soldiers live in one block; 'soldiers' orders them
+	pool_.reserve(count);
 	soldiers = new SoldierPtr[count];
 	int x = 0;
 	int y = count;
@@ -663,7 +767,9 @@ Army::Army(Unit *ldr, AList *locs, int regtype, int ass)
 
 				if (ItemDefs[ it->type ].type & IT_MAN)
 				{
-					soldiers[x] = new Soldier(u, obj, regtype, it->type, ass);
+					pool_.emplace_back(u, obj, regtype, it->type,
+					      SoldierName(u, it->type), SoldierKit(u), ass);
+					soldiers[x] = &pool_.back();
 					hitstotal = soldiers[x]->hits;
 					++x;
 					goto finished_army; // done
@@ -672,11 +778,13 @@ Army::Army(Unit *ldr, AList *locs, int regtype, int ass)
 		}
 		else
 		{
+			const SoldierKit kit(u);
 			Item *it = (Item*)u->items.First();
 			do
 			{
 				if (IsSoldier(it->type))
 				{
+					const AString *name = SoldierName(u, it->type);
 					for (int i = 0; i < it->num; ++i)
 					{
 						// if behind
@@ -684,12 +792,14 @@ Army::Army(Unit *ldr, AList *locs, int regtype, int ass)
 						    u->GetFlag(FLAG_BEHIND))
 						{
 							--y;
-							soldiers[y] = new Soldier(u, obj, regtype, it->type);
+							pool_.emplace_back(u, obj, regtype, it->type, name, kit);
+							soldiers[y] = &pool_.back();
 							hitstotal += soldiers[y]->hits;
 						}
 						else
 						{
-							soldiers[x] = new Soldier(u, obj, regtype, it->type);
+							pool_.emplace_back(u, obj, regtype, it->type, name, kit);
+							soldiers[x] = &pool_.back();
 							hitstotal += soldiers[x]->hits;
 							++x;
 						}
@@ -703,6 +813,9 @@ Army::Army(Unit *ldr, AList *locs, int regtype, int ass)
 finished_army:
 	tac = tac + tacspell;
 
+	for (auto &s : pool_)
+		s.army = this;
+
 	canfront = x;
 	canbehind = count;
 	notfront = count;
@@ -719,14 +832,34 @@ finished_army:
 
 Army::~Army()
 {
-	for (int i = 0; i < count; ++i)
-	{
-		delete soldiers[i];
-		soldiers[i] = NULL;
-	}
+	delete cohorts;
 	delete[] soldiers;
 }
 
+void Army::EndCohorts()
+{
+	if (!cohorts)
+		return;
+
+	cohorts->WriteBack();
+	delete cohorts;
+	cohorts = NULL;
+}
+
+const AString* Army::SoldierName(Unit *u, int race)
+{
+	if (!(ItemDefs[race].type & IT_MONSTER) || (ItemDefs[race].type & IT_MAN))
+		return u->name;
+
+	const MonType &mon_def = MonDefs[ItemDefs[race].index];
+	if (u->type == U_WMON)
+		names_.push_back(AString(mon_def.name) + " in " + *(u->name));
+	else
+		names_.push_back(AString(mon_def.name) + AString(" controlled by ") + *(u->name));
+
+	return &names_.back();
+}
+
 void Army::Reset()
 {
 	canfront = notfront;
@@ -906,7 +1039,7 @@ void Army::Regenerate(Battle *b)
 		if (diff <= 0)
 			continue; // no damage
 
-		AString aName = s->name;
+		const AString &aName = *s->name;
 
 		if (s->damage != 0)
 		{
@@ -927,6 +1060,8 @@ void Army::Regenerate(Battle *b)
 
 void Army::Lose(Battle *b, ItemList *spoils)
 {
+	EndCohorts();
+
 	for (int i = 0; i < count; ++i)
 	{
 		Soldier *&s = soldiers[i];
@@ -948,6 +1083,8 @@ void Army::Lose(Battle *b, ItemList *spoils)
 
 void Army::Tie(Battle *b)
 {
+	EndCohorts();
+
 	for (int x = 0; x < count; ++x)
 	{
 		Soldier *&s = soldiers[x];
@@ -977,6 +1114,8 @@ int Army::CanBeHealed()
 
 void Army::DoHeal(Battle *b)
 {
+	BattleTimer timer(b->profile, BP_HEAL);
+
 	// do magical healing
 	for (int i = 5; i > 0; --i)
 		DoHealLevel(b, i, 0);
@@ -1032,12 +1171,15 @@ void Army::DoHealLevel(Battle *b, int type, int useItems)
 			Soldier *temp = soldiers[j];
 			if (temp->canbehealed)
 			{
+				++b->profile.heals;
 				s->healing--;
 				if (getrandom(100) < rate)
 				{
 					n++;
 					soldiers[j] = soldiers[notbehind];
 					soldiers[notbehind] = temp;
+					Placed(j);
+					Placed(notbehind);
 					notbehind++;
 				}
 				else
@@ -1050,6 +1192,8 @@ void Army::DoHealLevel(Battle *b, int type, int useItems)
 
 void Army::Win(Battle *b, ItemList *spoils)
 {
+	EndCohorts();
+
 	DoHeal(b);
 
 	// check for casualties
@@ -1162,6 +1306,9 @@ Soldier* Army::GetAttacker(int i, int &behind)
 		soldiers[i] = soldiers[canfront-1];
 		soldiers[canfront-1] = soldiers[canbehind-1];
 		soldiers[canbehind-1] = retval;
+		Placed(i);
+		Placed(canfront-1);
+		Placed(canbehind-1);
 		canfront--;
 		canbehind--;
 		behind = 0;
@@ -1171,6 +1318,9 @@ Soldier* Army::GetAttacker(int i, int &behind)
 	soldiers[i] = soldiers[canbehind-1];
 	soldiers[canbehind-1] = soldiers[notfront-1];
 	soldiers[notfront-1] = retval;
+	Placed(i);
+	Placed(canbehind-1);
+	Placed(notfront-1);
 	canbehind--;
 	notfront--;
 	behind = 1;
@@ -1200,94 +1350,12 @@ int Army::GetTargetNum(int special)
 		return i + canbehind - canfront;
 	}
 
-	int validtargs = 0;
-	int i, start = -1;
-
-	for (i = 0; i < canfront; ++i)
-	{
-		if (CheckSpecialTarget(special, i))
-		{
-			validtargs++;
-			// slight scan optimisation - skip empty initial sequences
-			if (start == -1)
-				start = i;
-		}
-	}
-
-	for (i = canbehind; i < notfront; ++i)
-	{
-		if (CheckSpecialTarget(special, i))
-		{
-			validtargs++;
-			// slight scan optimisation - skip empty initial sequences
-			if (start == -1)
-				start = i;
-		}
-	}
-
-	if (validtargs)
-	{
-		int targ = getrandom(validtargs);
-
-		for (i = start; i < notfront; ++i)
-		{
-			if (i == canfront)
-				i = canbehind;
-
-			if (CheckSpecialTarget(special, i))
-			{
-				if (!targ--)
-					return i;
-			}
-		}
-	}
-
-	return -1;
+	return PickTarget(Index(special, -1));
 }
 
 int Army::GetEffectNum(int effect)
 {
-	int validtargs = 0;
-	int start = -1;
-
-	for (int i = 0; i < canfront; ++i)
-	{
-		if (soldiers[i]->HasEffect(effect))
-		{
-			validtargs++;
-			// slight scan optimisation - skip empty initial sequences
-			if (start == -1)
-				start = i;
-		}
-	}
-
-	for (int i = canbehind; i < notfront; ++i)
-	{
-		if (soldiers[i]->HasEffect(effect))
-		{
-			validtargs++;
-			// slight scan optimisation - skip empty initial sequences
-			if (start == -1)
-				start = i;
-		}
-	}
-
-	if (validtargs)
-	{
-		int targ = getrandom(validtargs);
-		for (int i = start; i < notfront; ++i)
-		{
-			if (i == canfront)
-				i = canbehind;
-
-			if (soldiers[i]->HasEffect(effect))
-			{
-				if (!targ--)
-					return i;
-			}
-		}
-	}
-	return -1;
+	return PickTarget(Index(-1, effect));
 }
 
 Soldier* Army::GetTarget(int i)
@@ -1315,6 +1383,91 @@ int Army::RemoveEffects(int num, int effect)
 	return ret;
 }
 
+TargetIndex& Army::Index(int special, int effect)
+{
+	for (auto &index : indexes_)
+	{
+		if (index.special == special && index.effect == effect)
+			return index;
+	}
+
+	if (where_.empty())
+	{
+		where_.resize(pool_.size());
+		for (int pos = 0; pos < count; ++pos)
+			where_[soldiers[pos] - pool_.data()] = pos;
+	}
+
+	indexes_.emplace_back(special, effect, count);
+	TargetIndex &index = indexes_.back();
+	for (int pos = 0; pos < count; ++pos)
+		index.Set(pos, Passes(index, pos));
+
+	return index;
+}
+
+bool Army::Passes(const TargetIndex &index, int pos)
+{
+	if (index.special != -1)
+		return CheckSpecialTarget(index.special, pos);
+
+	return soldiers[pos]->HasEffect(index.effect);
+}
+
+int Army::PickTarget(const TargetIndex &index)
+{
+	// targets are the front ranks: [0, canfront) and [canbehind, notfront)
+	const int front = index.Count(canfront);
+	const int skipped = index.Count(canbehind);
+	const int validtargs = front + index.Count(notfront) - skipped;
+	if (!validtargs)
+		return -1;
+
+	const int targ = getrandom(validtargs);
+	if (targ < front)
+		return index.Find(targ);
+
+	return index.Find(skipped + targ - front);
+}
+
+void Army::Placed(int pos)
+{
+	if (indexes_.empty())
+		return;
+
+	where_[soldiers[pos] - pool_.data()] = pos;
+	for (auto &index : indexes_)
+		index.Set(pos, Passes(index, pos));
+}
+
+void Army::EffectsChanged(const Soldier *s)
+{
+	if (indexes_.empty())
+		return;
+
+	Placed(where_[s - pool_.data()]);
+}
+
+int Army::AttackBin(int attackType, bool riding)
+{
+	switch (attackType)
+	{
+		case ATTACK_COMBAT:
+			return riding ? 1 : 0;
+		case ATTACK_RIDING:
+			return 1;
+		case ATTACK_RANGED:
+			return 2;
+		case ATTACK_ENERGY:
+			return 3;
+		case ATTACK_WEATHER:
+			return 4;
+		case ATTACK_SPIRIT:
+			return 5;
+	}
+	return 0;
+}
+
 int Army::DoAnAttack(int special, int numAttacks, int attackType,
       int attackLevel, int flags, int weaponClass, int effect,
       int mountBonus, int *num_killed, bool riding)
@@ -1339,24 +1492,7 @@ int Army::DoAnAttack(int special, int numAttacks, int attackType,
 			canShield = 1;
 			break;
 	}
-	int attack_bin = 0;
-	if (attackType == ATTACK_COMBAT)
-	{
-		if (riding)
-			attack_bin = 1;
-		else
-			attack_bin = 0;
-	}
-	else if (attackType == ATTACK_RIDING)
-		attack_bin = 1;
-	else if (attackType == ATTACK_RANGED)
-		attack_bin = 2;
-	else if (attackType == ATTACK_ENERGY)
-		attack_bin = 3;
-	else if (attackType == ATTACK_WEATHER)
-		attack_bin = 4;
-	else if (attackType == ATTACK_SPIRIT)
-		attack_bin = 5;
+	const int attack_bin = AttackBin(attackType, riding);
 
 	if (canShield)
 	{
@@ -1378,6 +1514,13 @@ int Army::DoAnAttack(int special, int numAttacks, int attackType,
 		}
 	}
 
+	if (Globals->BATCHED_ATTACKS && !effect && attackType != NUM_ATTACK_TYPES &&
+	    !SpecialDefs[special].targflags && numAttacks >= 8)
+	{
+		return DoBatchedAttacks(special, numAttacks, attackType, attackLevel,
+		      flags, weaponClass, mountBonus, num_killed, attack_bin);
+	}
+
 	// now, loop through and do attacks
 	int ret = 0;
 	for (int i = 0; i < numAttacks; ++i)
@@ -1483,6 +1626,139 @@ int Army::DoAnAttack(int special, int numAttacks, int attackType,
 	return ret;
 }
 
+int Army::DoBatchedAttacks(int special, int numAttacks, int attackType,
+      int attackLevel, int flags, int weaponClass, int mountBonus,
+      int *num_killed, int attack_bin)
+{
+	// A block of attacks is aimed and rolled against the front as it
+	// stands.  Only a kill changes the front, so the attacks after a kill
+	// are thrown away and drawn again in the next block: each attack then
+	// has the same odds as in DoAnAttack's loop, which also raises
+	// attackLevel for every attack that found a target.
+	enum { MAX_BLOCK = 64 };
+	int pos[MAX_BLOCK];
+	int level[MAX_BLOCK];
+	int tohit[MAX_BLOCK];
+	int tomiss[MAX_BLOCK];
+	int chance[MAX_BLOCK];
+	int from[MAX_BLOCK];
+	char hit[MAX_BLOCK];
+
+	int attLen = 1; // start at NORMAL
+	if (flags & WeaponType::LONG)
+		attLen = 2;
+	else if (flags & WeaponType::SHORT)
+		attLen = 0;
+
+	const bool noBuilding = special > 0 &&
+	      (SpecialDefs[special].effectflags & SpecialType::FX_NOBUILDING);
+
+	int ret = 0;
+	int block = 8;
+	for (int done = 0; done < numAttacks; )
+	{
+		int tars = NumFront();
+		// if front rank depleted
+		if (tars == 0)
+		{
+			// make behind units in front
+			canfront = canbehind;
+			notfront = notbehind;
+			tars = NumFront();
+			if (tars == 0)
+				break;
+		}
+
+		const int n = std::min(block, numAttacks - done);
+
+		// 1. get the targets
+		for (int k = 0; k < n; ++k)
+		{
+			const int i = getrandom(tars);
+			pos[k] = (i < canfront) ? i : i + canbehind - canfront;
+		}
+
+		// 2. work out the odds against each
+		int lev = attackLevel;
+		for (int k = 0; k < n; ++k)
+		{
+			const Soldier *tar = soldiers[pos[k]];
+
+			int tlev = tar->dskill[attackType];
+			if (noBuilding && tar->building)
+				tlev -= 2;
+
+			if ((flags & WeaponType::NODEFENSE) && tlev > 0)
+				tlev = 0;
+
+			if (!(flags & WeaponType::RANGED))
+			{
+				int tarFlags = 0;
+				if (tar->weapon != -1)
+					tarFlags = WeaponDefs[ItemDefs[tar->weapon].index].flags;
+
+				int defLen = 1;
+				if (tarFlags & WeaponType::LONG)
+					defLen = 2;
+				else if (tarFlags & WeaponType::SHORT)
+					defLen = 0;
+
+				if (attLen > defLen)
+					lev++;
+				else if (defLen > attLen)
+					tlev++;
+			}
+
+			if (tar->riding != -1)
+				lev += mountBonus;
+
+			level[k] = lev;
+			HitOdds(lev, tlev, tohit[k], tomiss[k]);
+			chance[k] = tar->ArmorChance(weaponClass, from[k]);
+		}
+
+		// 3. roll for readiness, hits and armour
+		for (int k = 0; k < n; ++k)
+		{
+			hit[k] = (flags & WeaponType::ALWAYSREADY) || !getrandom(2);
+		}
+		for (int k = 0; k < n; ++k)
+		{
+			hit[k] &= getrandom(tohit[k] + tomiss[k]) < tohit[k];
+		}
+		for (int k = 0; k < n; ++k)
+		{
+			if (chance[k] > 0)
+				hit[k] &= !(chance[k] > getrandom(from[k]));
+		}
+
+		// 4. apply the hits, up to the first kill
+		int k = 0;
+		bool killed = false;
+		while (k < n && !killed)
+		{
+			attackLevel = level[k];
+			if (hit[k])
+			{
+				killed = DamageSoldier(pos[k]);
+				++hits_from[attack_bin];
+				if (killed)
+				{
+					++*num_killed;
+					++kills_from[attack_bin];
+				}
+				++ret;
+			}
+			++k;
+		}
+
+		done += k;
+		block = killed ? std::max(block / 2, 1) : std::min(block * 2, (int)MAX_BLOCK);
+	}
+
+	return ret;
+}
+
 bool Army::DamageSoldier(int killed)
 {
 	Soldier *const temp = soldiers[killed];
@@ -1520,6 +1796,7 @@ bool Army::DamageSoldier(int killed)
 	{
 		soldiers[killed] = soldiers[canfront-1];
 		soldiers[canfront-1] = temp;
+		Placed(killed);
 		killed = canfront - 1;
 		canfront--;
 	}
@@ -1528,6 +1805,7 @@ bool Army::DamageSoldier(int killed)
 	{
 		soldiers[killed] = soldiers[canbehind-1];
 		soldiers[canbehind-1] = temp;
+		Placed(killed);
 		killed = canbehind-1;
 		canbehind--;
 	}
@@ -1536,12 +1814,15 @@ bool Army::DamageSoldier(int killed)
 	{
 		soldiers[killed] = soldiers[notfront-1];
 		soldiers[notfront-1] = temp;
+		Placed(killed);
 		killed = notfront-1;
 		notfront--;
 	}
 
 	soldiers[killed] = soldiers[notbehind-1];
 	soldiers[notbehind-1] = temp;
+	Placed(killed);
+	Placed(notbehind-1);
 	notbehind--;
 	return true;
 }
@@ -28,25 +28,44 @@
 #include "shields.h"
 #include "helper.h" // BITFIELD
 #include "astring.h"
+#include <deque>
+#include <vector>
+class Army;
 class Battle;
+class CohortArmy;
 class ItemList;
 class Object;
 class Unit;
 
+//----------------------------------------------------------------------------
+/// The kinds of equipment a unit holds when its soldiers are formed.  Each
+/// soldier looks only for these, rather than for every kind in the game
+/// (taking items out of the unit never adds a kind)
+struct SoldierKit
+{
+	explicit SoldierKit(Unit *unit);
+
+	std::vector<int> weapons;     ///< WeaponDefs indices, ascending
+	std::vector<int> armors;      ///< ArmorDefs indices, ascending
+	std::vector<int> mounts;      ///< MountDefs indices, ascending
+	std::vector<int> battleItems; ///< BattleItemDefs indices, ascending
+};
+
 //----------------------------------------------------------------------------
 /// One soldier in an army (wraps individual in unit)
 class Soldier
 {
 public:
-	/// construct one man of 'race' from 'unit', in 'object'
-	/// 'regType' is used for riding
-	Soldier(Unit *unit, Object *object, int regType, int race, int ass=0);
+	/// construct one man of 'race' from 'unit', in 'object', called 'name'
+	/// 'regType' is used for riding, 'kit' is what 'unit' holds
+	Soldier(Unit *unit, Object *object, int regType, int race,
+	      const AString *name, const SoldierKit &kit, int ass=0);
 
 	/// check assigned spell
 	void SetupSpell();
 
-	/// get weapon and armor
-	void SetupCombatItems();
+	/// get battle items (of the kinds in 'kit')
+	void SetupCombatItems(const SoldierKit &kit);
 
 	/// game-specific, and appears in specials.cpp
 	void SetupHealing();
@@ -67,6 +86,9 @@ public:
 	///@return 1 if armor is (randomly) successful
 	int ArmorProtect(int weaponClass) const;
 
+	///@return chance in 'from' of armor stopping 'weaponClass'
+	int ArmorChance(int weaponClass, int &from) const;
+
 	/// give items back to original unit
 	void RestoreItems();
 
@@ -77,10 +99,25 @@ public:
 	void Dead();
 
 public: // data
-	AString name;
+	// combat state, read on every attack (kept together)
+	int hits;
+	int dskill[NUM_ATTACK_TYPES];
+	int armor;
+	int effects;
+	int riding;
+	int weapon;
+	int attacktype;
+	int askill;
+	int attacks;
+	int special;
+	int slevel;
+	int maxhits;
+	int damage;
+
+	const AString *name; ///< shared by all soldiers of a unit (and race)
 	Unit *unit;
+	Army *army; ///< told when effects change, for its target indexes
 	int race;
-	int riding;
 	int building;
 
 	// Healing information
@@ -90,29 +127,44 @@ public: // data
 	int canbehealed;
 	int regen;
 
-	// Attack info
-	int weapon;
-	int attacktype;
-	int askill;
-	int attacks;
-	int special;
-	int slevel;
-
-	// Defense info
-	int dskill[NUM_ATTACK_TYPES];
-	int armor;
-	int hits;
-	int maxhits;
-	int damage;
-
 	BITFIELD battleItems;
 	int amuletofi;
-
-	int effects;
 };
 
 typedef Soldier *SoldierPtr;
 
+/// odds of attack level 'a' hitting defense 'd': 'tohit' in 'tohit'+'tomiss'
+void HitOdds(int a, int d, int &tohit, int &tomiss);
+
+///@return 1 if attack level 'a' (randomly) hits defense 'd'
+int Hits(int a, int d);
+
+//----------------------------------------------------------------------------
+/// The positions in an army's soldiers[] which pass one targeting test, in
+/// a Fenwick tree, so the n-th passing position can be found in O(log n)
+class TargetIndex
+{
+public:
+	TargetIndex(int special, int effect, int size);
+
+	/// record whether position 'pos' passes
+	void Set(int pos, bool in);
+
+	///@return number of passing positions before 'end'
+	int Count(int end) const;
+
+	///@return the 'n'th (from 0) passing position
+	int Find(int n) const;
+
+public: // data
+	int special; ///< tests CheckSpecialTarget for this special, or -1
+	int effect;  ///< tests HasEffect for this effect, or -1
+
+private:
+	std::vector<char> in_;
+	std::vector<int> tree_;
+};
+
 //----------------------------------------------------------------------------
 /// All of the soldiers on one side
 class Army
@@ -177,6 +229,9 @@ public:
 	/// try to remove 'effect' from 'num' soldiers, @return actual number removed
 	int RemoveEffects(int num, int effect);
 
+	/// keep the target indexes right after soldier 's' gained or lost effects
+	void EffectsChanged(const Soldier *s);
+
 	/// evaluate one attack on us
 	int DoAnAttack( int special, int numAttacks, int attackType,
 	      int attackLevel, int flags, int weaponClass, int effect,
@@ -189,6 +244,9 @@ public:
 	// in specials.cpp
 	int CheckSpecialTarget(int, int);
 
+	///@return index into kills_from/hits_from for 'attackType'
+	static int AttackBin(int attackType, bool riding);
+
 public: // data
 	SoldierPtr *soldiers;
 	Unit *leader;
@@ -207,10 +265,43 @@ public: // data
 	int kills_from[6];
 	int hits_from[6];
 
+	CohortArmy *cohorts; ///< counted view of the soldiers, if fighting as cohorts
+
 private:
 	void DoHealLevel(Battle *b, int type, int useItems);
 
+	/// the damaging part of DoAnAttack, with the attacks drawn and rolled a
+	/// block at a time (BATCHED_ATTACKS)
+	///@return number of hits
+	int DoBatchedAttacks(int special, int numAttacks, int attackType,
+	      int attackLevel, int flags, int weaponClass, int mountBonus,
+	      int *num_killed, int attack_bin);
+
+	///@return name for soldiers of 'race' from 'u'
+	const AString* SoldierName(Unit *u, int race);
+
 	void WriteLosses(Battle *b);
+
+	/// copy the results of a cohort battle back into the soldiers
+	void EndCohorts();
+
+	///@return the index for 'special' (or 'effect'), built on first use
+	TargetIndex& Index(int special, int effect);
+
+	///@return true if soldiers[pos] passes the test of 'index'
+	bool Passes(const TargetIndex &index, int pos);
+
+	///@return random front position passing 'index', or -1
+	int PickTarget(const TargetIndex &index);
+
+	/// keep the target indexes right after a soldier moved to 'pos'
+	void Placed(int pos);
+
+private:
+	std::vector<Soldier> pool_; ///< storage for 'soldiers' (never resized)
+	std::deque<AString> names_; ///< monster names, shared per unit and race
+	std::deque<TargetIndex> indexes_; ///< targeting tests asked for so far
+	std::vector<int> where_; ///< position in soldiers[] by pool_ entry (with indexes)
 };
 
 #endif
@@ -24,8 +24,8 @@
 // END A3HEADER
 #include "astring.h"
 #include <cstring>
-#include <cstdio>
 #include <string>
+#include <utility>
 
 static bool islegal(char c)
 {
@@ -37,76 +37,198 @@ static bool islegal(char c)
 	        c=='/' || c=='~' || c=='\'' || c== '\\' || c=='`';
 }
 
+namespace
+{
+/// write the digits of 'v' so that they end at 'end', @return the first digit
+char* formatDigits(char *end, unsigned v)
+{
+	do
+	{
+		*--end = char('0' + v % 10);
+		v /= 10;
+	} while (v);
+
+	return end;
+}
+} // anonymous namespace
+
 AString::AString()
 {
-	len_ = 0;
-	str_ = new char[1];
-	str_[0] = '\0';
+	sso_[0] = '\0';
 }
 
 AString::AString(const char *s)
 {
-	len_ = strlen(s);
-	str_ = new char[len_ + 1];
-	strcpy(str_, s);
+	assign(s, strlen(s));
 }
 
 AString::AString(int l)
 {
 	char buf[16];
-	sprintf(buf, "%d", l);
-	len_ = strlen(buf);
-	str_ = new char[len_ + 1];
-	strcpy(str_, buf);
+	char *const end = buf + sizeof(buf);
+	char *p = formatDigits(end, l < 0 ? 0u - unsigned(l) : unsigned(l));
+	if (l < 0)
+		*--p = '-';
+
+	assign(p, int(end - p));
 }
 
 AString::AString(unsigned l)
 {
 	char buf[16];
-	sprintf(buf, "%u", l);
-	len_ = strlen(buf);
-	str_ = new char[len_ + 1];
-	strcpy(str_, buf);
+	char *const end = buf + sizeof(buf);
+	char *p = formatDigits(end, l);
+	assign(p, int(end - p));
 }
 
 AString::AString(char c)
 {
-	len_ = 1;
-	str_ = new char[2];
-	str_[0] = c;
-	str_[1] = '\0';
+	assign(&c, 1);
 }
 
 AString::~AString()
 {
-	delete[] str_;
+	if (!isInline())
+		delete[] str_;
 }
 
 AString::AString(const AString &s)
 {
-	len_ = s.len_;
-	str_ = new char[len_ + 1];
-	strcpy(str_, s.str_);
+	assign(s.str_, s.len_);
+}
+
+AString::AString(AString &&s)
+{
+	if (s.isInline())
+	{
+		assign(s.str_, s.len_);
+	}
+	else
+	{
+		// take the buffer
+		str_ = s.str_;
+		cap_ = s.cap_;
+		len_ = s.len_;
+
+		s.str_ = s.sso_;
+		s.cap_ = SSO_CAP;
+	}
+
+	s.len_ = 0;
+	s.str_[0] = '\0';
 }
 
 AString& AString::operator=(const AString &s)
 {
-	delete[] str_;
-	len_ = s.len_;
-	str_ = new char[len_ + 1];
-	strcpy(str_, s.str_);
+	assign(s.str_, s.len_);
+	return *this;
+}
+
+AString& AString::operator=(AString &&s)
+{
+	if (this == &s)
+		return *this;
+
+	if (s.isInline())
+	{
+		assign(s.str_, s.len_);
+	}
+	else
+	{
+		// take the buffer
+		if (!isInline())
+			delete[] str_;
+
+		str_ = s.str_;
+		cap_ = s.cap_;
+		len_ = s.len_;
+
+		s.str_ = s.sso_;
+		s.cap_ = SSO_CAP;
+	}
+
+	s.len_ = 0;
+	s.str_[0] = '\0';
 	return *this;
 }
 
 AString& AString::operator=(const char *c)
 {
-	delete[] str_;
-	len_ = strlen(c);
-	str_ = new char[len_ + 1];
-	strcpy(str_, c);
+	assign(c, strlen(c));
 	return *this;
 }
 
+void AString::reserve(int n)
+{
+	if (n <= cap_)
+		return;
+
+	int cap = cap_ * 2;
+	if (cap < n)
+		cap = n;
+
+	char *buf = new char[cap + 1];
+	memcpy(buf, str_, len_ + 1);
+
+	if (!isInline())
+		delete[] str_;
+
+	str_ = buf;
+	cap_ = cap;
+}
+
+void AString::assign(const char *s, int n)
+{
+	if (n > cap_)
+	{
+		// copy before freeing, in case 's' is in the old buffer
+		char *buf = new char[n + 1];
+		memcpy(buf, s, n);
+
+		if (!isInline())
+			delete[] str_;
+
+		str_ = buf;
+		cap_ = n;
+	}
+	else
+	{
+		memmove(str_, s, n);
+	}
+
+	len_ = n;
+	str_[len_] = '\0';
+}
+
+void AString::append(const char *s, int n)
+{
+	const int len = len_ + n;
+	if (len > cap_)
+	{
+		// grow geometrically, copying before freeing (s may be this)
+		int cap = cap_ * 2;
+		if (cap < len)
+			cap = len;
+
+		char *buf = new char[cap + 1];
+		memcpy(buf, str_, len_);
+		memcpy(buf + len_, s, n);
+
+		if (!isInline())
+			delete[] str_;
+
+		str_ = buf;
+		cap_ = cap;
+	}
+	else
+	{
+		memmove(str_ + len_, s, n);
+	}
+
+	len_ = len;
+	str_[len_] = '\0';
+}
+
 bool AString::operator==(const char *s) const
 {
 	return isEqual(s);
@@ -142,45 +264,24 @@ bool AString::isEqual(const char *temp2) const
 	return *temp1 == *temp2;
 }
 
-AString AString::operator+(const AString &s) const
+AString AString::operator+(const AString &s) const &
 {
-	char *temp = new char[len_ + s.len_ + 1];
-
-	int i; // live-out
-	for (i = 0; i < len_; ++i)
-	{
-		temp[i] = str_[i];
-	}
-
-	for (int j = 0; j < s.len_ + 1; ++j)
-	{
-		temp[i++] = s.str_[j];
-	}
+	AString ret;
+	ret.reserve(len_ + s.len_);
+	ret.append(str_, len_);
+	ret.append(s.str_, s.len_);
+	return ret;
+}
 
-	AString temp2 = AString(temp);
-	delete[] temp;
-	return temp2;
+AString AString::operator+(const AString &s) &&
+{
+	append(s.str_, s.len_);
+	return std::move(*this);
 }
 
 AString& AString::operator+=(const AString &s)
 {
-	char *temp = new char[len_ + s.len_ + 1];
-
-	int i; // live-out
-	for (i = 0; i < len_; ++i)
-	{
-		temp[i] = str_[i];
-	}
-
-	for (int j = 0; j < s.len_ + 1; ++j)
-	{
-		temp[i++] = s.str_[j];
-	}
-
-	delete[] str_;
-	str_ = temp;
-	len_ += s.len_;
-
+	append(s.str_, s.len_);
 	return *this;
 }
 
@@ -201,6 +302,8 @@ int AString::len() const
 
 AString* AString::gettoken()
 {
+	const int max_token = 1023; // longer tokens consume the whole string
+
 	// find start of non-whitespace token
 	int place = 0;
 	while (place < len_ && (str_[place] == ' ' || str_[place] == '\t'))
@@ -211,28 +314,25 @@ AString* AString::gettoken()
 	// only comment
 	if (str_[place] == ';') return 0;
 
-	char buf[1024];
-	size_t place2 = 0;
+	int start = place;
+	int toklen = 0;
 
 	// handle quoted token
 	if (str_[place] == '"')
 	{
 		++place; // skip start quote
+		start = place;
 
-		while (place2 < sizeof(buf)-1 && place < len_ && str_[place] != '"')
+		while (toklen < max_token && place < len_ && str_[place] != '"')
 		{
-			// copy token to buf
-			buf[place2++] = str_[place++];
+			++toklen;
+			++place;
 		}
 
-		if (place == len_ || place2 == sizeof(buf)-1)
+		if (place == len_ || toklen == max_token)
 		{
 			// Unmatched "" return 0, truncate self (no more tokens)
-			delete str_;
-			str_ = new char[1];
-			len_ = 0;
-			str_[0] = '\0';
-
+			assign("", 0);
 			return 0;
 		}
 		//else
@@ -242,44 +342,28 @@ AString* AString::gettoken()
 	}
 	else // unquoted token
 	{
-		while (place2 < sizeof(buf)-1 && place < len_ &&
+		while (toklen < max_token && place < len_ &&
 		       str_[place] != ' ' && str_[place] != '\t' && str_[place] != ';')
 		{
-			buf[place2++] = str_[place++];
+			++toklen;
+			++place;
 		}
 	}
 
-	buf[place2] = '\0';
+	AString *token = new AString;
+	token->assign(str_ + start, toklen);
 
-	if (place2 == sizeof(buf)-1 || place == len_ || str_[place] == ';')
+	if (toklen == max_token || place == len_ || str_[place] == ';')
 	{
-		delete[] str_;
-		str_ = new char[1];
-		len_ = 0;
-		str_[0] = '\0';
-
-		return new AString(buf);
+		assign("", 0);
+		return token;
 	}
 
 	// adjust self to remainder
-	char *buf2 = new char[len_ - place2 + 1];
-	int newlen = 0;
-	place2 = 0;
-	while (place < len_)
-	{
-		buf2[place2++] = str_[place++];
-
-		++newlen;
-	}
-
-	buf2[place2] = '\0';
-
-	len_ = newlen;
-	delete[] str_;
-	str_ = buf2;
+	assign(str_ + place, len_ - place);
 
 	// return token
-	return new AString(buf);
+	return token;
 }
 
 AString* AString::stripWhite() const
@@ -314,29 +398,25 @@ int AString::getat()
 
 AString* AString::getlegal() const
 {
-	char *temp = new char[len_ + 1];
-	char *temp2 = temp;
+	AString *retval = new AString;
+	retval->reserve(len_);
+
 	bool j = false;
 	for (int i = 0; i < len_; ++i)
 	{
 		if (islegal(str_[i]))
 		{
-			*temp2 = str_[i];
+			retval->append(&str_[i], 1);
 			if (str_[i] != ' ') j = true;
-
-			++temp2;
 		}
 	}
 
 	if (!j)
 	{
-		delete temp;
+		delete retval;
 		return 0;
 	}
 
-	*temp2 = '\0';
-	AString * retval = new AString(temp);
-	delete[] temp;
 	return retval;
 }
 
@@ -349,13 +429,16 @@ AString* AString::trunc(int val, int back)
 	{
 		if (str_[i] == ' ')
 		{
+			AString *temp = new AString(&(str_[i+1]));
 			str_[i] = '\0';
-			return new AString(&(str_[i+1]));
+			len_ = i;
+			return temp;
 		}
 	}
 
 	AString *temp = new AString(&(str_[val]));
 	str_[val] = '\0';
+	len_ = val;
 	return temp;
 }
 
@@ -405,10 +488,7 @@ std::istream& operator>>(std::istream &is, AString &s)
 	std::string buf;
 	is >> buf;
 
-	s.len_ = int(buf.size());
-	s.str_ = new char[s.len_ + 1];
-	strcpy(s.str_, buf.c_str());
+	s.assign(buf.data(), int(buf.size()));
 
 	return is;
 }
-
@@ -39,15 +39,18 @@ public:
 	AString(unsigned);
 	AString(char);
 	AString(const AString&);
+	AString(AString&&);
 	~AString();
 
 	bool operator==(const AString&) const;
 	bool operator==(const char*) const;
 
-	AString operator+(const AString&) const;
+	AString operator+(const AString&) const &;
+	AString operator+(const AString&) &&; ///< appends in place to a temporary
 	AString& operator+=(const AString&);
 
 	AString& operator=(const AString&);
+	AString& operator=(AString&&);
 	AString& operator=(const char*);
 
 	///@deprecated
@@ -98,9 +101,22 @@ public:
 private:
 	bool isEqual(const char*) const;
 
+	/// make room for 'n' chars (plus terminator), keeping the contents
+	void reserve(int n);
+	/// replace the contents with 'n' chars from 's'
+	void assign(const char *s, int n);
+	/// add 'n' chars from 's' to the end
+	void append(const char *s, int n);
+	/// @return true if the chars are in sso_
+	bool isInline() const { return str_ == sso_; }
+
 private:
-	int len_;
-	char *str_;
+	enum { SSO_CAP = 15 }; ///< longest string stored without allocating
+
+	int len_ = 0;
+	int cap_ = SSO_CAP; ///< chars which fit in str_ (not counting terminator)
+	char *str_ = sso_;
+	char sso_[SSO_CAP + 1];
 };
 
 #endif
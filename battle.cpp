@@ -26,6 +26,7 @@
 #include "faction.h"
 #include "game.h"
 #include "army.h"
+#include "cohort.h"
 #include "gamedata.h"
 #include "gamedefs.h"
 #include "object.h"
@@ -33,20 +34,57 @@
 #include "unit.h"
 #include "fileio.h"
 #include "gameio.h"
+#include <algorithm>
+#include <memory>
+#include <unordered_set>
+#include <vector>
 
 //----------------------------------------------------------------------------
-Battle::Battle()
+void BattleText::Add(const AString &s)
+{
+	Areport::Wrap(text_, s, 0);
+}
+
+void BattleText::Report(Areport *f) const
+{
+	f->PutWrapped(text_);
+}
+
+BattleTimer::BattleTimer(BattleProfile &profile, int part)
+: seconds_(profile.timing ? &profile.seconds[part] : NULL)
 {
-	asstext = NULL;
+	if (seconds_)
+		start_ = std::chrono::steady_clock::now();
 }
 
-Battle::~Battle()
+BattleTimer::~BattleTimer()
+{
+	if (seconds_)
+	{
+		const std::chrono::duration<double> d = std::chrono::steady_clock::now() - start_;
+		*seconds_ += d.count();
+	}
+}
+
+//----------------------------------------------------------------------------
+Battle::Battle()
+: text(std::make_shared<BattleText>())
 {
-	delete asstext;
+	rounds = 0;
+	attacks = 0;
+	profile.timing = Globals->BATTLE_PROFILE;
 }
 
 void Battle::FreeRound(Army *att, Army *def, int ass)
 {
+	BattleTimer timer(profile, BP_FREE);
+
+	if (att->cohorts)
+	{
+		CohortFreeRound(att, def);
+		return;
+	}
+
 	// write header
 	AddLine(*att->leader->faction->name + " gets a free round of attacks.");
 
@@ -116,7 +154,7 @@ void Battle::DoAttack(int round, Soldier *a, Army *attackers, Army *def,
 
 			if (tot != -1)
 			{
-				AddLine(a->name + " " + spd->spelldesc + ", " +
+				AddLine(*a->name + " " + spd->spelldesc + ", " +
 				      spd->spelldesc2 + tot + spd->spelltarget + ".");
 			}
 		}
@@ -165,6 +203,7 @@ void Battle::DoAttack(int round, Soldier *a, Army *attackers, Army *def,
 			attackClass = pWep->weapClass;
 		}
 
+		++attacks;
 		def->DoAnAttack( 0, 1, attackType, a->askill, flags, attackClass,
 		      0, mountBonus, &num_killed, a->riding != -1);
 
@@ -177,6 +216,14 @@ void Battle::DoAttack(int round, Soldier *a, Army *attackers, Army *def,
 
 void Battle::NormalRound(int round, Army *a, Army *b)
 {
+	BattleTimer timer(profile, BP_ROUNDS);
+
+	if (a->cohorts)
+	{
+		CohortNormalRound(round, a, b);
+		return;
+	}
+
 	// write round header
 	AddLine(AString("Round ") + round + ":");
 
@@ -281,14 +328,30 @@ int Battle::Run(ARegion *region,
                   int    ass,
                   ARegionList *pRegs)
 {
+	BattleTimer timer(profile, BP_TOTAL);
+
 	// set some state
 	assassination = ASS_NONE;
 	attacker = att->faction;
 
 	// form the two armies
 	Army *armies[2];
-	armies[0] = new Army(att, atts, region->type, ass);
-	armies[1] = new Army(tar, defs, region->type, ass);
+	{
+		BattleTimer armiesTimer(profile, BP_ARMIES);
+		armies[0] = new Army(att, atts, region->type, ass);
+		armies[1] = new Army(tar, defs, region->type, ass);
+	}
+	profile.soldiers[0] = armies[0]->count;
+	profile.soldiers[1] = armies[1]->count;
+
+	// optionally fight plain armies as counted cohorts
+	if (Globals->COHORT_BATTLES && !ass &&
+	    CohortArmy::Supports(armies[0]) && CohortArmy::Supports(armies[1]))
+	{
+		armies[0]->cohorts = new CohortArmy(armies[0]);
+		armies[1]->cohorts = new CohortArmy(armies[1]);
+		profile.cohorts = true;
+	}
 
 	// check for assassination and tactics
 	if (ass)
@@ -306,6 +369,7 @@ int Battle::Run(ARegion *region,
 	int round = 1;
 	while (!armies[0]->Broken() && !armies[1]->Broken() && round < 101)
 	{
+		++rounds;
 		NormalRound(round++, armies[0], armies[1]);
 	}
 
@@ -328,9 +392,11 @@ int Battle::Run(ARegion *region,
 
 		AddLine("Total Casualties:");
 
+		BattleTimer endTimer(profile, BP_END);
 		ItemList *spoils = new ItemList;
 		armies[0]->Lose(this, spoils);
 		GetSpoils(atts, spoils, ass);
+		CountSpoils(spoils);
 
 		AString temp;
 		if (spoils->Num())
@@ -359,10 +425,12 @@ int Battle::Run(ARegion *region,
 		if (ass)
 		{
 			assassination = ASS_SUCC;
-			asstext = new AString(*(armies[1]->leader->name) +
-			                      " is assassinated in " +
-			                      region->ShortPrint( pRegs ) +
-			                      "!");
+			asstext = std::make_shared<BattleText>();
+			asstext->Add(*(armies[1]->leader->name) +
+			             " is assassinated in " +
+			             region->ShortPrint( pRegs ) +
+			             "!");
+			asstext->Add("");
 		}
 
 		if (armies[1]->NumAlive())
@@ -377,9 +445,11 @@ int Battle::Run(ARegion *region,
 
 		AddLine("Total Casualties:");
 
+		BattleTimer endTimer(profile, BP_END);
 		ItemList *spoils = new ItemList;
 		armies[1]->Lose(this, spoils);
 		GetSpoils(defs, spoils, ass);
+		CountSpoils(spoils);
 
 		AString temp;
 		if (spoils->Num())
@@ -408,6 +478,7 @@ int Battle::Run(ARegion *region,
 	AddLine("");
 	AddLine("Total Casualties:");
 
+	BattleTimer endTimer(profile, BP_END);
 	armies[0]->Tie(this);
 	armies[1]->Tie(this);
 	AddLine("");
@@ -421,6 +492,14 @@ int Battle::Run(ARegion *region,
 	return BATTLE_DRAW;
 }
 
+void Battle::CountSpoils(ItemList *spoils)
+{
+	forlist(spoils)
+	{
+		profile.spoils += ((Item*)elem)->num;
+	}
+}
+
 void Battle::WriteSides(ARegion *r,
                         Unit *att,
                         Unit *tar,
@@ -479,25 +558,17 @@ void Battle::WriteSides(ARegion *r,
 	AddLine("");
 }
 
-void Battle::Report(Areport *f, Faction *fac)
+std::shared_ptr<const BattleText> Battle::Report(const Faction *fac) const
 {
 	if (assassination == ASS_SUCC && fac != attacker)
-	{
-		f->PutStr(*asstext);
-		f->PutStr("");
-		return;
-	}
+		return asstext;
 
-	forlist(&text)
-	{
-		AString *s = (AString*)elem;
-		f->PutStr(*s);
-	}
+	return text;
 }
 
 void Battle::AddLine(const AString &s)
 {
-	text.Add(new AString(s));
+	text->Add(s);
 }
 
 void Game::GetDFacs(ARegion *r, Unit *t, AList &facs)
@@ -604,34 +675,124 @@ void Game::GetAFacs(ARegion *r, Unit *att, Unit *tar, AList &dfacs,
 	}
 }
 
-int Game::CanAttack(ARegion *r, AList *afacs, Unit *u)
+namespace
 {
+//----------------------------------------------------------------------------
+/// What the attacking factions have in the battle region, for deciding which
+/// units trying to avoid the battle are forced into it.  Each faction's best
+/// observation, attack riding and mind reading there answers Faction::CanSee
+/// and Faction::CanCatch for units of the region, so the region is searched
+/// once per battle rather than once per avoiding unit and attacking faction
+class Pursuers
+{
+public:
+	Pursuers(ARegion *r, AList *afacs) : region_(r), afacs_(afacs) {}
+
+	///@return true if the attackers can both see and catch 'u' (in the region)
+	bool CanAttack(Unit *u);
+
+private:
+	/// one attacking faction's best in the region
+	struct Pursuer
+	{
+		Faction *faction;
+		int observation = -1;     ///< best observation of its units
+		int riding = -1;          ///< best attack riding of its units
+		bool mindReading = false; ///< a unit can detect factions
+	};
+
+	/// search the region for the units of the attacking factions
+	void gather();
+
+	///@return true if 'p' can see 'u' well enough to attack it
+	bool canSee(const Pursuer &p, Unit *u) const;
+
+private:
+	ARegion *region_;
+	AList *afacs_;
+	std::vector<Pursuer> pursuers_; ///< one per attacking faction, once gathered
+};
+
+void Pursuers::gather()
+{
+	{
+		forlist(afacs_)
+		{
+			Pursuer p;
+			p.faction = ((FactionPtr*)elem)->ptr;
+			pursuers_.push_back(p);
+		}
+	}
+
+	forlist(&region_->objects)
+	{
+		Object *o = (Object*)elem;
+		for (auto &u : o->getUnits())
+		{
+			for (Pursuer &p : pursuers_)
+			{
+				if (u->faction != p.faction)
+					continue;
+
+				p.observation = std::max(p.observation, u->GetSkill(S_OBSERVATION));
+				p.riding = std::max(p.riding, u->GetAttackRiding());
+				if (u->GetSkill(S_MIND_READING) > 2)
+					p.mindReading = true;
+			}
+		}
+	}
+}
+
+bool Pursuers::canSee(const Pursuer &p, Unit *u) const
+{
+	// as Faction::CanSee() == 2
+	if (u->faction == p.faction || u->reveal == REVEAL_FACTION)
+		return true;
+
+	const int stealth = u->GetSkill(S_STEALTH);
+	if (p.observation > stealth)
+		return true;
+
+	const bool noticed = u->reveal == REVEAL_UNIT ||
+	      u->object->type != O_DUMMY || p.observation == stealth;
+	return noticed && p.mindReading;
+}
+
+bool Pursuers::CanAttack(Unit *u)
+{
+	if (pursuers_.empty())
+		gather();
+
 	// must both see and ride
 	bool see  = false;
 	bool ride = false;
 
-	forlist(afacs)
+	// (as Faction::CanCatch)
+	if (TerrainDefs[region_->type].similar_type == R_OCEAN ||
+	    u->object->type != O_DUMMY)
 	{
-		FactionPtr *f = (FactionPtr*)elem;
-
-		if (f->ptr->CanSee(r, u) == 2)
-		{
-			if (ride)
-				return 1;
+		ride = true;
+	}
 
+	int def = -1;
+	for (const Pursuer &p : pursuers_)
+	{
+		if (!see && canSee(p, u))
 			see = true;
-		}
 
-		if (f->ptr->CanCatch(r, u))
+		if (!ride)
 		{
-			if (see)
-				return 1;
-
-			ride = true;
+			if (def == -1)
+				def = u->GetDefenseRiding();
+			ride = p.riding >= def;
 		}
+
+		if (see && ride)
+			return true;
 	}
 
-	return 0;
+	return false;
+}
 }
 
 void Game::GetSides(ARegion *r, AList &afacs, AList &dfacs, AList &atts,
@@ -655,6 +816,16 @@ void Game::GetSides(ARegion *r, AList &afacs, AList &dfacs, AList &atts,
 		return;
 	}
 
+	// attackers found so far, and who the attackers can force into battle
+	std::unordered_set<int> attackers;
+	{
+		forlist(&atts)
+		{
+			attackers.insert(((Location*)elem)->unit->num);
+		}
+	}
+	Pursuers pursuers(r, &afacs);
+
 	int noaida = 0, noaidd = 0; // loop-carry
 	// -1 is current region, then check neighboring regions for support
 	for (int i = -1; i < NDIRS; ++i)
@@ -707,7 +878,7 @@ void Game::GetSides(ARegion *r, AList &afacs, AList &dfacs, AList &atts,
 							if (u->canattack &&
 							      (u->guard != GUARD_AVOID || u == att) &&
 							      u->CanMoveTo(r2, r) &&
-							      !::GetUnit(&atts, u->num))
+							      !attackers.count(u->num))
 							{
 								add = ADD_ATTACK;
 							}
@@ -745,7 +916,7 @@ void Game::GetSides(ARegion *r, AList &afacs, AList &dfacs, AList &atts,
 										if (u == tar ||
 										    (u->faction == tar->faction &&
 										     i == -1 &&
-										     CanAttack(r, &afacs, u)))
+										     pursuers.CanAttack(u)))
 										{
 											add = ADD_DEFENSE;
 										}
@@ -766,6 +937,7 @@ void Game::GetSides(ARegion *r, AList &afacs, AList &dfacs, AList &atts,
 
 				if (add == ADD_ATTACK)
 				{
+					attackers.insert(u->num);
 					Location *l = new Location;
 					l->unit = u;
 					l->obj = o;
@@ -830,6 +1002,39 @@ void Game::KillDead(Location *l)
 	}
 }
 
+std::string Game::ProfileLine(const Battle &b, ARegion *r, Unit *attacker,
+      Unit *target, int ass, int result)
+{
+	const BattleProfile &p = b.profile;
+	char buf[512];
+	int n = snprintf(buf, sizeof(buf), "%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d",
+	      r->num, r->xloc, r->yloc, r->zloc, attacker->num, target->num, ass,
+	      result, p.soldiers[0], p.soldiers[1], b.rounds, b.attacks,
+	      p.specials, p.heals, p.spoils);
+	for (int i = 0; i < BP_NUM; ++i)
+		n += snprintf(buf + n, sizeof(buf) - n, "\t%.3f", p.seconds[i] * 1000);
+
+	return buf;
+}
+
+void Game::WriteBattleProfile()
+{
+	Aoutfile f;
+	if (f.OpenByName(AString("battles.") + TurnNumber()) == -1)
+	{
+		Awrite("Couldn't write the battle profile!");
+		return;
+	}
+
+	f.PutStr("region\tx\ty\tz\tattacker\ttarget\tass\tresult"
+	         "\tattackers\tdefenders\trounds\tattacks\tspecials\theals\tspoils"
+	         "\ttotal_ms\tarmies_ms\tfree_ms\trounds_ms\tspecials_ms\tend_ms\theal_ms");
+	for (const std::string &line : battleProfile)
+		f.PutStr(line.c_str());
+
+	battleProfile.clear();
+}
+
 int Game::RunBattle(ARegion *r, Unit *attacker, Unit *target, int ass, int adv)
 {
 	AList afacs, dfacs;
@@ -894,11 +1099,10 @@ int Game::RunBattle(ARegion *r, Unit *attacker, Unit *target, int ass, int adv)
 		return BATTLE_IMPOSSIBLE;
 	}
 
-	Battle *b = new Battle;
+	std::unique_ptr<Battle> b(new Battle);
 	b->WriteSides(r, attacker, target, &atts, &defs, ass, &regions);
 
-	battles.Add(b);
-
+	std::vector<Faction*> reportTo;
 	forlist(&factions)
 	{
 		Faction *f = (Faction*)elem;
@@ -906,14 +1110,40 @@ int Game::RunBattle(ARegion *r, Unit *attacker, Unit *target, int ass, int adv)
 		if (GetFaction2(&afacs, f->num) || GetFaction2(&dfacs, f->num) ||
 		    r->Present(f))
 		{
-			BattlePtr *p = new BattlePtr;
-			p->ptr = b;
-			f->battles.Add(p);
+			reportTo.push_back(f);
 		}
 	}
 
+	std::unique_ptr<RandomStream> stream(TakeStream({RS_BATTLE, unsigned(r->num),
+	      unsigned(r->battlesFought++)}));
+	RandomStream::Use use(stream.get());
+
 	const int result = b->Run(r, attacker, &atts, target, &defs, ass, &regions);
 
+	// each faction shares one copy of its report of the battle
+	std::vector<std::pair<Faction*, std::shared_ptr<const BattleText>>> reports;
+	for (Faction *f : reportTo)
+		reports.emplace_back(f, b->Report(f));
+
+	std::string profileLine;
+	if (Globals->BATTLE_PROFILE)
+		profileLine = ProfileLine(*b, r, attacker, target, ass, result);
+
+	auto addReports = [this, reports, profileLine]()
+	{
+		for (const auto &report : reports)
+			report.first->battles.push_back(report.second);
+
+		if (!profileLine.empty())
+			battleProfile.push_back(profileLine);
+	};
+
+	// battles on worker threads are reported after their region group
+	if (FactionLog *log = FactionLog::Current())
+		log->Add(addReports);
+	else
+		addReports();
+
 	// remove all dead units
 	{
 		forlist(&atts)
@@ -24,12 +24,16 @@
 // http://www.prankster.com/project
 //
 // END A3HEADER
-#include "alist.h"
+#include <chrono>
+#include <memory>
+#include <string>
+class AList;
 class ARegion;
 class ARegionList;
 class Areport;
 class Army;
 class AString;
+class Cohort;
 class Faction;
 class ItemList;
 class Soldier;
@@ -53,16 +57,72 @@ enum
 	BATTLE_DRAW
 };
 
+/// Parts of a battle timed by BattleProfile
+enum
+{
+	BP_TOTAL,    ///< the whole of Battle::Run
+	BP_ARMIES,   ///< forming the armies
+	BP_FREE,     ///< free rounds (tactics, assassination and rout)
+	BP_ROUNDS,   ///< normal rounds
+	BP_SPECIALS, ///< special attacks (within the rounds)
+	BP_END,      ///< casualties and spoils
+	BP_HEAL,     ///< healing the winners (within the end)
+	BP_NUM
+};
+
+//----------------------------------------------------------------------------
+/// Counts and wall times of one battle (see Globals->BATTLE_PROFILE)
+struct BattleProfile
+{
+	bool timing = false;      ///< measure the times as well as count
+	int soldiers[2] = {0, 0}; ///< of the attacking and defending armies
+	int specials = 0;         ///< damaging special attacks fired
+	int heals = 0;            ///< attempts to heal a casualty
+	int spoils = 0;           ///< items taken as spoils
+	bool cohorts = false;     ///< fought by CohortArmy
+	double seconds[BP_NUM] = {};
+};
+
+/// Adds the wall time of its scope to one part of a BattleProfile
+class BattleTimer
+{
+public:
+	BattleTimer(BattleProfile &profile, int part);
+	~BattleTimer();
+
+private:
+	double *seconds_; ///< NULL if not timing
+	std::chrono::steady_clock::time_point start_;
+};
+
+//----------------------------------------------------------------------------
+/// A battle report, formatted once as it is written, then shared by the
+/// reports of every faction which saw the battle
+class BattleText
+{
+public:
+	/// add line 's', wrapped as the report will show it
+	void Add(const AString &s);
+
+	/// send the whole text to report 'f'
+	void Report(Areport *f) const;
+
+	///@return bytes of text held
+	size_t Size() const { return text_.size(); }
+
+private:
+	std::string text_;
+};
+
 //----------------------------------------------------------------------------
 /// Handles battle mechanics and reporting
-class Battle : public AListElem
+class Battle
 {
 public:
 	Battle();
-	~Battle();
 
-	/// Send this battle report to 'f' for 'fac'
-	void Report(Areport *f, Faction *fac);
+	///@return the report of this battle for 'fac'
+	std::shared_ptr<const BattleText> Report(const Faction *fac) const;
 
 	/// Add 's' to this battle report
 	void AddLine(const AString &s);
@@ -77,22 +137,30 @@ private: // methods
 	void DoAttack(int round, Soldier *a, Army *attackers, Army *def,
 	         int behind, bool ass = false);
 	void GetSpoils(AList *losers, ItemList *spoils, int ass);
+	/// add the items in 'spoils' to the profile
+	void CountSpoils(ItemList *spoils);
 
 	// These functions should be implemented in specials.cpp
 	void UpdateShields(Army *);
 	void DoSpecialAttack(int round, Soldier *a, Army *attackers, Army *def, int behind);
 
+	// These functions are implemented in cohort.cpp
+	void CohortFreeRound(Army *att, Army *def);
+	void CohortNormalRound(int round, Army *a, Army *b);
+	void CohortAttack(int round, const Cohort *a, Army *def, int behind, int n = 1);
+	/// fight a volley of 'a' on 'b' (and of 'b' on 'a', if 'both')
+	///@return false, changing nothing, if the armies are too small for one
+	bool CohortVolley(Army *a, Army *b, bool both);
+
 public: // data
 	int assassination;
 	Faction *attacker; ///< Only matters in the case of an assassination
-	AString *asstext;
-	AList text;
-};
+	std::shared_ptr<BattleText> asstext; ///< for all but the attacker, if assassinated
+	std::shared_ptr<BattleText> text;
 
-class BattlePtr : public AListElem
-{
-public:
-	Battle *ptr;
+	int rounds;  ///< normal rounds fought
+	int attacks; ///< weapon attacks made (in any round)
+	BattleProfile profile;
 };
 
 #endif
@@ -0,0 +1,514 @@
+// START A3HEADER
+//
+// This source file is part of the Atlantis PBM game program.
+// Copyright (C) 1995-1999 Geoff Dunbar
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program, in the file license.txt. If not, write
+// to the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+// Boston, MA 02111-1307, USA.
+//
+// See the Atlantis Project web page for details:
+// http://www.prankster.com/project
+//
+// END A3HEADER
+
+// Battle simulator: fights one battle, read from a text file, many times
+// over and reports how fast it ran and how it came out.  Asked to compare,
+// it fights the same seeds again with the other battle engine (see
+// GameDefs::COHORT_BATTLES) and fails if the outcomes differ by more than
+// chance, or if the cohort engine can't fight the battle.  The file holds one keyword per line (';' starts a comment):
+//
+//   TERRAIN <terrain>        where the battle is fought (default plain)
+//   ATTACKER [<name>]        the following units attack
+//   DEFENDER [<name>]        the following units defend
+//   UNIT [MONSTER]           start a new unit on the current side
+//   ITEM <num> <item>        men, monsters and equipment of the unit
+//   SKILL <skill> <level>    (after the unit's men)
+//   COMBAT <skill>           combat spell
+//   BEHIND                   the unit fights from behind
+//   BUILDING <object>        the unit is inside a building of this type
+//                            (units of one side in the same type share it)
+#include "game.h"
+#include "aregion.h"
+#include "astring.h"
+#include "battle.h"
+#include "faction.h"
+#include "fileio.h"
+#include "gamedata.h"
+#include "gamedefs.h"
+#include "gameio.h"
+#include "items.h"
+#include "object.h"
+#include "skills.h"
+#include "unit.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace
+{
+/// a unit as described in the battle file
+struct SimUnit
+{
+	int type = U_NORMAL;
+	int object = -1; ///< building type, or -1 for none
+	int flags = 0;
+	int combat = -1;
+	std::vector<std::pair<int, int>> items;  ///< item, number
+	std::vector<std::pair<int, int>> skills; ///< skill, level
+};
+
+/// one side of the battle
+struct SimSide
+{
+	AString name;
+	std::vector<SimUnit> units;
+};
+
+/// the whole battle file
+struct SimBattle
+{
+	int terrain = R_PLAIN;
+	SimSide sides[2];
+};
+
+///@return terrain named 'token', or -1
+int ParseTerrain(const AString &token)
+{
+	for (int i = 0; i < R_NUM; ++i)
+	{
+		if (token == TerrainDefs[i].name)
+			return i;
+	}
+	return -1;
+}
+
+///@return false (with a message) if 'battlefile' can't be read into 'sim'
+bool ReadSimBattle(const AString &battlefile, SimBattle &sim)
+{
+	Aorders f;
+	if (f.OpenByName(battlefile) == -1)
+	{
+		Awrite(AString("Couldn't open the battle file ") + battlefile + "!");
+		return false;
+	}
+
+	sim.sides[0].name = "Attacker";
+	sim.sides[1].name = "Defender";
+
+	SimSide *side = nullptr;
+	SimUnit *unit = nullptr;
+	int lineNum = 0;
+	for (std::unique_ptr<AString> pLine(f.GetLine()); pLine; pLine.reset(f.GetLine()))
+	{
+		++lineNum;
+		std::unique_ptr<AString> pToken(pLine->gettoken());
+		if (!pToken)
+			continue;
+
+		AString error;
+		if (*pToken == "terrain")
+		{
+			pToken.reset(pLine->gettoken());
+			sim.terrain = pToken ? ParseTerrain(*pToken) : -1;
+			if (sim.terrain == -1)
+				error = "unknown terrain";
+		}
+		else if (*pToken == "attacker" || *pToken == "defender")
+		{
+			side = &sim.sides[*pToken == "attacker" ? 0 : 1];
+			unit = nullptr;
+			pToken.reset(pLine->gettoken());
+			if (pToken)
+				side->name = *pToken;
+		}
+		else if (*pToken == "unit")
+		{
+			if (!side)
+			{
+				error = "UNIT before ATTACKER or DEFENDER";
+			}
+			else
+			{
+				side->units.emplace_back();
+				unit = &side->units.back();
+				pToken.reset(pLine->gettoken());
+				if (pToken && *pToken == "monster")
+					unit->type = U_WMON;
+			}
+		}
+		else if (!unit)
+		{
+			error = AString("no UNIT for ") + *pToken;
+		}
+		else if (*pToken == "item")
+		{
+			pToken.reset(pLine->gettoken());
+			const int num = pToken ? pToken->value() : 0;
+			pToken.reset(pLine->gettoken());
+			const int item = pToken ? ParseEnabledItem(*pToken) : -1;
+			if (num <= 0 || item == -1)
+				error = "expected ITEM <num> <enabled item>";
+			else
+				unit->items.emplace_back(item, num);
+		}
+		else if (*pToken == "skill")
+		{
+			pToken.reset(pLine->gettoken());
+			const int skill = ParseSkill(pToken.get());
+			pToken.reset(pLine->gettoken());
+			const int level = pToken ? pToken->value() : 0;
+			if (skill == -1 || level <= 0)
+				error = "expected SKILL <skill> <level>";
+			else
+				unit->skills.emplace_back(skill, level);
+		}
+		else if (*pToken == "combat")
+		{
+			pToken.reset(pLine->gettoken());
+			unit->combat = ParseSkill(pToken.get());
+			if (unit->combat == -1)
+				error = "unknown skill";
+		}
+		else if (*pToken == "behind")
+		{
+			unit->flags |= FLAG_BEHIND;
+		}
+		else if (*pToken == "building")
+		{
+			pToken.reset(pLine->gettoken());
+			unit->object = pToken ? ParseObject(pToken.get()) : -1;
+			if (unit->object == -1 || !ObjectDefs[unit->object].protect)
+				error = "expected BUILDING <building type>";
+		}
+		else
+		{
+			error = AString("unknown keyword ") + *pToken;
+		}
+
+		if (!(error == ""))
+		{
+			Awrite(battlefile + ":" + lineNum + ": " + error);
+			return false;
+		}
+	}
+
+	for (const SimSide &s : sim.sides)
+	{
+		if (s.units.empty())
+		{
+			Awrite(AString("No units for ") + s.name + "!");
+			return false;
+		}
+	}
+	return true;
+}
+
+/// running mean and variance of one number, keeping every value
+struct SimStat
+{
+	double sum = 0;
+	double sumSq = 0;
+	std::vector<double> values;
+
+	void add(double x) { sum += x; sumSq += x * x; values.push_back(x); }
+	double mean(int n) const { return sum / n; }
+	double sd(int n) const { return sqrt(std::max(0.0, sumSq / n - mean(n) * mean(n))); }
+};
+
+/// totals over all runs of one battle file
+struct SimOutcome
+{
+	int results[4] = {0};
+	SimStat survivors[2];
+	SimStat men[2];
+	double rounds = 0;
+	double attacks = 0;
+	int cohortRuns = 0; ///< runs fought by CohortArmy
+	BattleProfile profile;
+	std::chrono::duration<double> elapsed{0};
+};
+
+/// standard errors two outcomes may differ by before the engines are said
+/// to disagree (about one false alarm in 370 per number compared)
+const double SIM_TOLERANCE = 3;
+
+/// the same for the distance between two distributions of survivors, in
+/// the Kolmogorov-Smirnov test (about one false alarm in 1000)
+const double SIM_KS_TOLERANCE = 1.95;
+
+/// fight 'sim' 'runs' times, with seeds from 'seed'
+void FightRuns(Game &game, const SimBattle &sim, int runs, int seed, SimOutcome &out)
+{
+	for (int run = 0; run < runs; ++run)
+	{
+		// everything is built again, as the battle uses up the units
+		ARegion region;
+		region.type = sim.terrain;
+
+		std::vector<std::unique_ptr<Faction>> factions;
+		std::vector<std::unique_ptr<Unit>> units[2];
+		std::vector<std::unique_ptr<Object>> objects;
+		AList locations[2];
+		int unitNum = 1;
+
+		for (int s = 0; s < 2; ++s)
+		{
+			factions.emplace_back(new Faction(game, s + 1));
+			Faction *fac = factions.back().get();
+			fac->SetName(new AString(sim.sides[s].name));
+
+			// know every item already, so spoils don't write descriptions
+			for (unsigned i = 0; i < ItemDefs.size(); ++i)
+				fac->items.SetNum(i, 2);
+
+			std::map<int, Object*> buildings;
+			Object *outside = new Object(&region);
+			objects.emplace_back(outside);
+
+			for (const SimUnit &su : sim.sides[s].units)
+			{
+				Unit *u = new Unit(unitNum++, fac);
+				units[s].emplace_back(u);
+				u->type = su.type;
+				u->flags = su.flags;
+				u->combat = su.combat;
+				// only mages cast their combat spell
+				if (su.combat != -1 && su.type == U_NORMAL)
+					u->type = U_MAGE;
+				for (const auto &i : su.items)
+					u->items.SetNum(i.first, u->items.GetNum(i.first) + i.second);
+				for (const auto &sk : su.skills)
+					u->SetSkill(sk.first, sk.second);
+
+				Object *obj = outside;
+				if (su.object != -1)
+				{
+					Object *&b = buildings[su.object];
+					if (!b)
+					{
+						b = new Object(&region);
+						b->type = su.object;
+						b->incomplete = 0;
+						b->capacity = ObjectDefs[su.object].protect;
+						objects.emplace_back(b);
+					}
+					obj = b;
+				}
+
+				Location *l = new Location;
+				l->unit = u;
+				l->obj = obj;
+				l->region = &region;
+				locations[s].Add(l);
+			}
+
+			int soldiers = 0;
+			for (auto &u : units[s])
+				soldiers += u->GetSoldiers();
+			out.men[s].add(soldiers);
+		}
+
+		seedrandom(seed + run);
+
+		Battle b;
+		b.profile.timing = true;
+		const auto start = std::chrono::steady_clock::now();
+		const int result = b.Run(&region, units[0].front().get(), &locations[0],
+		                         units[1].front().get(), &locations[1], 0, nullptr);
+		out.elapsed += std::chrono::steady_clock::now() - start;
+
+		++out.results[result];
+		out.rounds += b.rounds;
+		out.attacks += b.attacks;
+		if (b.profile.cohorts)
+			++out.cohortRuns;
+		out.profile.specials += b.profile.specials;
+		out.profile.heals += b.profile.heals;
+		out.profile.spoils += b.profile.spoils;
+		for (int i = 0; i < BP_NUM; ++i)
+			out.profile.seconds[i] += b.profile.seconds[i];
+		for (int s = 0; s < 2; ++s)
+		{
+			int alive = 0;
+			for (auto &u : units[s])
+				alive += u->GetSoldiers();
+			out.survivors[s].add(alive);
+		}
+	}
+}
+
+/// report how 'runs' battles came out and how fast they were fought
+void WriteOutcome(const SimBattle &sim, int runs, const SimOutcome &out)
+{
+	const double secs = out.elapsed.count();
+	char buf[256];
+
+	for (int s = 0; s < 2; ++s)
+	{
+		snprintf(buf, sizeof(buf), "  %s: %.0f soldiers, %.1f survive (sd %.1f)",
+		         sim.sides[s].name.str(), out.men[s].mean(runs),
+		         out.survivors[s].mean(runs), out.survivors[s].sd(runs));
+		Awrite(buf);
+	}
+	snprintf(buf, sizeof(buf), "  attacker won %.1f%%, lost %.1f%%, drew %.1f%%",
+	         100.0 * out.results[BATTLE_WON] / runs,
+	         100.0 * out.results[BATTLE_LOST] / runs,
+	         100.0 * out.results[BATTLE_DRAW] / runs);
+	Awrite(buf);
+	snprintf(buf, sizeof(buf), "  %.2f rounds and %.0f attacks per battle",
+	         out.rounds / runs, out.attacks / runs);
+	Awrite(buf);
+	snprintf(buf, sizeof(buf), "  %.1f specials, %.1f heal attempts and %.1f spoils per battle",
+	         double(out.profile.specials) / runs, double(out.profile.heals) / runs,
+	         double(out.profile.spoils) / runs);
+	Awrite(buf);
+	const double *ms = out.profile.seconds;
+	snprintf(buf, sizeof(buf), "  ms per battle: armies %.3f, free rounds %.3f, rounds %.3f"
+	         " (specials %.3f), end %.3f (healing %.3f)",
+	         ms[BP_ARMIES] * 1000 / runs, ms[BP_FREE] * 1000 / runs,
+	         ms[BP_ROUNDS] * 1000 / runs, ms[BP_SPECIALS] * 1000 / runs,
+	         ms[BP_END] * 1000 / runs, ms[BP_HEAL] * 1000 / runs);
+	Awrite(buf);
+	snprintf(buf, sizeof(buf), "  %.3f s in battle: %.1f battles/s, %.0f rounds/s, %.0f attacks/s",
+	         secs, runs / secs, out.rounds / secs, out.attacks / secs);
+	Awrite(buf);
+}
+
+///@return false (with a message) if 'a' and 'b' differ by more than
+/// SIM_TOLERANCE standard errors 'se' (or by 'slack', for exact numbers)
+bool Agrees(const char *what, double a, double b, double se, double slack)
+{
+	if (fabs(a - b) <= std::max(SIM_TOLERANCE * se, slack))
+		return true;
+
+	char buf[256];
+	snprintf(buf, sizeof(buf), "  %s differs: %.3f against %.3f", what, a, b);
+	Awrite(buf);
+	return false;
+}
+
+///@return false (with a message) if the values of 'a' and 'b' are spread
+/// differently by more than chance would have them
+bool SameSpread(const char *what, const SimStat &a, const SimStat &b)
+{
+	std::vector<double> x = a.values, y = b.values;
+	std::sort(x.begin(), x.end());
+	std::sort(y.begin(), y.end());
+
+	// the greatest distance between the two cumulative distributions
+	double d = 0;
+	size_t i = 0, j = 0;
+	while (i < x.size() && j < y.size())
+	{
+		const double v = std::min(x[i], y[j]);
+		while (i < x.size() && x[i] == v)
+			++i;
+		while (j < y.size() && y[j] == v)
+			++j;
+		d = std::max(d, fabs(double(i) / x.size() - double(j) / y.size()));
+	}
+
+	const double n = x.size(), m = y.size();
+	const double limit = SIM_KS_TOLERANCE * sqrt((n + m) / (n * m));
+	if (d <= limit)
+		return true;
+
+	char buf[256];
+	snprintf(buf, sizeof(buf), "  %s spread differs: distance %.3f, at most %.3f",
+	         what, d, limit);
+	Awrite(buf);
+	return false;
+}
+
+///@return false (with messages) if outcomes 'a' and 'b' of 'runs' battles
+/// each differ by more than chance would have them
+bool SameOutcome(int runs, const SimOutcome &a, const SimOutcome &b)
+{
+	bool same = true;
+	for (int r : {BATTLE_WON, BATTLE_LOST})
+	{
+		const double pa = double(a.results[r]) / runs;
+		const double pb = double(b.results[r]) / runs;
+		const double se = sqrt((pa * (1 - pa) + pb * (1 - pb)) / runs);
+		same &= Agrees(r == BATTLE_WON ? "attacker win rate" : "attacker loss rate",
+		               pa, pb, se, 1.0 / runs);
+	}
+
+	for (int s = 0; s < 2; ++s)
+	{
+		// the mean and spread of the survivors stand for the casualties
+		const double sa = a.survivors[s].sd(runs);
+		const double sb = b.survivors[s].sd(runs);
+		same &= Agrees(s ? "defender survivors" : "attacker survivors",
+		               a.survivors[s].mean(runs), b.survivors[s].mean(runs),
+		               sqrt((sa * sa + sb * sb) / runs), 0.5);
+		same &= Agrees(s ? "defender survivors sd" : "attacker survivors sd",
+		               sa, sb, sqrt((sa * sa + sb * sb) / (2 * runs)), 0.5);
+		same &= SameSpread(s ? "defender survivors" : "attacker survivors",
+		                   a.survivors[s], b.survivors[s]);
+	}
+	return same;
+}
+}
+
+int Game::SimulateBattles(const AString &battlefile, int runs, int seed,
+      bool compare)
+{
+	SimBattle sim;
+	if (!ReadSimBattle(battlefile, sim))
+		return 0;
+
+	if (runs <= 0)
+		return 1;
+
+	SimOutcome out;
+	FightRuns(*this, sim, runs, seed, out);
+
+	Awrite(AString("Fought ") + runs + " battles in " + TerrainDefs[sim.terrain].name +
+	       ", seeds " + seed + " to " + (seed + runs - 1) + ":");
+	WriteOutcome(sim, runs, out);
+	if (!compare)
+		return 1;
+
+	// the same seeds again with the other engine
+	const int cohorts = Globals->COHORT_BATTLES;
+	Globals->COHORT_BATTLES = !cohorts;
+	SimOutcome other;
+	FightRuns(*this, sim, runs, seed, other);
+	Globals->COHORT_BATTLES = cohorts;
+
+	// a battle the cohort engine can't fight tests nothing
+	if (out.cohortRuns + other.cohortRuns != runs)
+	{
+		Awrite("The cohort engine can't fight this battle!");
+		return 0;
+	}
+
+	Awrite(AString("With the ") + (cohorts ? "per-soldier" : "cohort") +
+	       " engine (" + (out.cohortRuns + other.cohortRuns) + " battles as cohorts):");
+	WriteOutcome(sim, runs, other);
+	if (!SameOutcome(runs, out, other))
+	{
+		Awrite("The cohort and per-soldier engines disagree!");
+		return 0;
+	}
+
+	Awrite("The cohort and per-soldier engines agree.");
+	return 1;
+}
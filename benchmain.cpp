@@ -0,0 +1,56 @@
+// START A3HEADER
+//
+// This source file is part of the Atlantis PBM game program.
+// Copyright (C) 1995-1999 Geoff Dunbar
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program, in the file license.txt. If not, write
+// to the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+// Boston, MA 02111-1307, USA.
+//
+// See the Atlantis Project web page for details:
+// http://www.prankster.com/project
+//
+// END A3HEADER
+
+// Benchmark program: runs one of the benchmarks in benchmark.cpp, linked
+// with a rule set like the game (see the benchmark targets in the
+// Makefile).  It exits with 1 if there is no benchmark of that name.
+#include "game.h"
+#include "gameio.h"
+#include "astring.h"
+
+int main(int argc, const char *argv[])
+{
+	Game game;
+
+	initIO();
+
+	if (argc < 2 || argc > 3) {
+		Awrite("benchmark <name> [<count>]");
+		doneIO();
+		return 1;
+	}
+
+	game.ModifyTablesPerRuleset();
+	game.resolveBackRefs();
+
+	const int count = argc > 2 ? AString(argv[2]).value() : 0;
+
+	const int ok = game.RunBenchmark(argv[1], count);
+	if (!ok)
+		Awrite(AString("No benchmark called ") + argv[1] + ".");
+
+	doneIO();
+	return ok ? 0 : 1;
+}
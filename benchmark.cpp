@@ -0,0 +1,297 @@
+// START A3HEADER
+//
+// This source file is part of the Atlantis PBM game program.
+// Copyright (C) 1995-1999 Geoff Dunbar
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program, in the file license.txt. If not, write
+// to the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+// Boston, MA 02111-1307, USA.
+//
+// See the Atlantis Project web page for details:
+// http://www.prankster.com/project
+//
+// END A3HEADER
+
+// Benchmarks: each one times a piece of the game that a turn leans on, on
+// work made up for the purpose, and prints how fast it went.  They are
+// run by the benchmark program (see benchmain.cpp), one per name.  Like
+// the game, "save" and "report" write their files in the current directory.
+#include "game.h"
+#include "astring.h"
+#include "faction.h"
+#include "fileio.h"
+#include "gamedata.h"
+#include "gamedefs.h"
+#include "gameio.h"
+#include "items.h"
+#include "orders.h"
+#include "skills.h"
+#include "unit.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+/// wall time since it was made
+class Stopwatch
+{
+public:
+	Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+	///@return seconds since the stopwatch was made
+	double Seconds() const
+	{
+		const std::chrono::duration<double> d = std::chrono::steady_clock::now() - start_;
+		return d.count();
+	}
+
+private:
+	std::chrono::steady_clock::time_point start_;
+};
+
+/// sends std::cout to a string while it lives, keeping the game's progress
+/// messages out of the results
+class Quiet
+{
+public:
+	Quiet() : out_(std::cout.rdbuf(text_.rdbuf())) {}
+	~Quiet() { std::cout.rdbuf(out_); }
+
+private:
+	std::ostringstream text_;
+	std::streambuf *out_;
+};
+
+/// print that 'count' 'what' took 'seconds'
+void Report(const char *name, double count, const char *what, double seconds)
+{
+	char buf[256];
+	snprintf(buf, sizeof(buf), "%s: %.0f %s in %.3f s, %.0f per second",
+	         name, count, what, seconds, seconds > 0 ? count / seconds : 0);
+	Awrite(buf);
+}
+
+/// save a generated 128x80 world in both formats and load it back, 'count'
+/// times each, printing the fastest of each
+void BenchmarkSave(int count)
+{
+	Game game;
+	{
+		// answer CreateWorld's questions
+		std::istringstream answers(Globals->MULTI_HEX_NEXUS ? "1\n128\n80\n60\n" : "128\n80\n60\n");
+		std::streambuf *in = std::cin.rdbuf(answers.rdbuf());
+		Quiet quiet;
+		game.NewGame(1);
+		std::cin.rdbuf(in);
+	}
+
+	for (bool binary : {false, true})
+	{
+		game.setBinarySave(binary);
+		double save = 0, load = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			Stopwatch saving;
+			game.SaveGame();
+			save = i ? std::min(save, saving.Seconds()) : saving.Seconds();
+			std::rename("game.out", "game.in");
+
+			Game loaded;
+			Quiet quiet;
+			Stopwatch loading;
+			loaded.OpenGame();
+			load = i ? std::min(load, loading.Seconds()) : loading.Seconds();
+		}
+
+		const double size = std::ifstream("game.in", std::ios::binary | std::ios::ate).tellg();
+		std::remove("game.in");
+
+		char buf[256];
+		snprintf(buf, sizeof(buf), "save: %.2f MB %s, saved in %.3f s, loaded in %.3f s",
+		         size / 1e6, binary ? "binary" : "text", save, load);
+		Awrite(buf);
+	}
+}
+
+/// write 1000 lines of report text 'count' times through Areport::PutStr,
+/// at indents 0 to 3, printing the throughput
+void BenchmarkReport(int count)
+{
+	static const char *const words[] = {
+		"Unit", "(1234),", "Faction", "[SILV],", "silver", "leader", "behind,",
+		"revealing", "avoiding,", "2", "swords", "Skills:", "combat", "[COMB]",
+		"5", "(450).", "Can", "Study:", "a", "the", "of", "and"
+	};
+	const int nwords = sizeof(words) / sizeof(words[0]);
+
+	// lines of up to 40 words, one in twenty with a word too long to wrap at
+	seedrandom(1);
+	std::vector<AString> lines;
+	for (int i = 0; i < 1000; ++i)
+	{
+		AString line;
+		for (int w = getrandom(40); w >= 0; --w)
+			line += AString(words[getrandom(nwords)]) + (w ? " " : "");
+		if (!getrandom(20))
+			line += std::string(80, 'x').c_str();
+		lines.push_back(line);
+	}
+
+	Areport f;
+	if (f.OpenByName("report.bench") == -1)
+		return;
+
+	Stopwatch clock;
+	for (int pass = 0; pass < count; ++pass)
+	{
+		for (size_t i = 0; i < lines.size(); ++i)
+		{
+			if (i % 4)
+				f.AddTab();
+			else
+				f.ClearTab();
+			f.PutStr(lines[i], i % 7 == 0);
+		}
+	}
+	f.Close();
+	const double seconds = clock.Seconds();
+
+	const double size = std::ifstream("report.bench", std::ios::binary | std::ios::ate).tellg();
+	std::remove("report.bench");
+
+	char buf[256];
+	snprintf(buf, sizeof(buf), "report: %.1f MB in %.3f s, %.1f MB/s",
+	         size / 1e6, seconds, seconds > 0 ? size / 1e6 / seconds : 0);
+	Awrite(buf);
+}
+
+/// build 'count' report lines with AString + and split as many orders into
+/// tokens, printing how many of each pair went through per second
+void BenchmarkStrings(int count)
+{
+	const AString name("Lord Doomsday");
+	const AString order("give 1234 50 \"silver\" ; pay the guards");
+
+	Stopwatch clock;
+	double chars = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		// a report line, built the way the report code builds them
+		const AString line = AString("* ") + name + " (" + i + "), Faction (" +
+		      (i % 50) + "), " + (i % 9) + " swords [SWOR], " + (3 * i) +
+		      " silver [SILV].";
+		chars += line.len();
+
+		// and an order, taken apart as the order parser does
+		AString rest = order;
+		for (AString *token = rest.gettoken(); token; token = rest.gettoken())
+		{
+			chars += token->len();
+			delete token;
+		}
+	}
+	const double seconds = clock.Seconds();
+
+	char buf[256];
+	snprintf(buf, sizeof(buf), "strings: %d lines and orders (%.1f MB) in %.3f s, %.0f per second",
+	         count, chars / 1e6, seconds, seconds > 0 ? count / seconds : 0);
+	Awrite(buf);
+}
+
+/// look up every item, skill and order name, in upper and lower case and
+/// with a word appended, as an item, a skill and an order, 'count' times
+void BenchmarkParse(int count)
+{
+	std::vector<std::string> names;
+	for (const auto &item : ItemDefs)
+	{
+		for (const char *name : {item.name, item.names, item.abr})
+		{
+			if (name)
+				names.push_back(name);
+		}
+	}
+	for (int i = 0; i < NSKILLS; ++i)
+	{
+		names.push_back(SkillDefs[i].name);
+		names.push_back(SkillDefs[i].abbr);
+	}
+	for (int i = 0; i < NORDERS; ++i)
+		names.push_back(OrderStrs[i]);
+
+	std::vector<AString> tokens;
+	for (std::string name : names)
+	{
+		tokens.push_back(name.c_str());
+		tokens.push_back((name + "x").c_str()); // no match
+		for (char &ch : name)
+			ch = (ch >= 'a' && ch <= 'z') ? ch - 'a' + 'A' : ch;
+		tokens.push_back(name.c_str());
+	}
+
+	Stopwatch clock;
+	for (int pass = 0; pass < count; ++pass)
+	{
+		for (AString &token : tokens)
+		{
+			ParseEnabledItem(token);
+			ParseSkill(&token);
+			Parse1Order(&token);
+		}
+	}
+	Report("parse", 3.0 * tokens.size() * count, "lookups", clock.Seconds());
+}
+}
+
+void Game::BenchmarkNewUnits(int count)
+{
+	// an empty world, so every unit is numbered past the last
+	SetupUnitNums();
+	Faction fac(*this, 1);
+
+	Stopwatch clock;
+	for (int i = 0; i < count; ++i)
+		GetNewUnit(&fac);
+	Report("units", count, "new units", clock.Seconds());
+
+	for (unsigned i = 1; i < unitseq; ++i)
+		delete GetUnit(i);
+	SetupUnitNums();
+}
+
+int Game::RunBenchmark(const AString &name, int count)
+{
+	const std::map<std::string, std::pair<std::function<void(int)>, int>> benchmarks = {
+		{"parse", {BenchmarkParse, 150}},
+		{"report", {BenchmarkReport, 200}},
+		{"save", {BenchmarkSave, 3}},
+		{"strings", {BenchmarkStrings, 300000}},
+		{"units", {[this](int n) { BenchmarkNewUnits(n); }, 100000}}
+	};
+
+	auto i = benchmarks.find(name.str());
+	if (i == benchmarks.end())
+		return 0;
+
+	i->second.first(count > 0 ? count : i->second.second);
+	return 1;
+}
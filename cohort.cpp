@@ -0,0 +1,960 @@
+// START A3HEADER
+//
+// This source file is part of the Atlantis PBM game program.
+// Copyright (C) 1995-1999 Geoff Dunbar
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program, in the file license.txt. If not, write
+// to the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+// Boston, MA 02111-1307, USA.
+//
+// See the Atlantis Project web page for details:
+// http://www.prankster.com/project
+//
+// END A3HEADER
+#include "cohort.h"
+#include "army.h"
+#include "battle.h"
+#include "faction.h"
+#include "gamedata.h"
+#include "gamedefs.h"
+#include "gameio.h"
+#include "unit.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <map>
+
+/// a volley aims at most one attack per VOLLEY_SHARE soldiers in an army's
+/// front rank, so few of its soldiers die before they would have attacked
+const int VOLLEY_SHARE = 16;
+
+/// volleys expected to make fewer attacks are fought one soldier at a time
+const int VOLLEY_MIN = 16;
+
+//----------------------------------------------------------------------------
+// Random draws for volleys.  These search outwards from the most likely
+// count, so take a few steps where drawing each trial would take n.
+
+///@return a uniform number in (0, 1)
+static double Uniform()
+{
+	return (getrandom(1 << 30) + 0.5) / (1 << 30);
+}
+
+///@return log of the number of ways to choose 'k' of 'n'
+static double LogChoose(int n, int k)
+{
+	return lgamma(n + 1.0) - lgamma(k + 1.0) - lgamma(n - k + 1.0);
+}
+
+///@return a draw from the distribution on [lo, hi] that has chance 'pm' of
+/// its mode 'm', where up(k) is P(k + 1) / P(k) and down(k) is P(k - 1) / P(k)
+template <class Up, class Down>
+static int FromMode(int lo, int hi, int m, double pm, Up up, Down down)
+{
+	double u = Uniform() - pm;
+	if (u < 0)
+		return m;
+
+	double pl = pm, ph = pm;
+	for (int l = m, h = m; l > lo || h < hi; )
+	{
+		if (h < hi)
+		{
+			ph *= up(h++);
+			if ((u -= ph) < 0)
+				return h;
+		}
+		if (l > lo)
+		{
+			pl *= down(l--);
+			if ((u -= pl) < 0)
+				return l;
+		}
+	}
+
+	return m; // only reached through rounding
+}
+
+///@return successes in 'n' trials with chance 'p' each
+static int Binomial(int n, double p)
+{
+	if (n <= 0 || p <= 0)
+		return 0;
+	if (p >= 1)
+		return n;
+
+	if (n < 16)
+	{
+		int k = 0;
+		for (int i = 0; i < n; ++i)
+			k += (Uniform() < p);
+		return k;
+	}
+
+	const double q = 1 - p;
+	const int m = std::min(n, int((n + 1) * p));
+	const double pm = exp(LogChoose(n, m) + m * log(p) + (n - m) * log(q));
+	return FromMode(0, n, m, pm,
+	      [=](int k) { return (n - k) * p / ((k + 1) * q); },
+	      [=](int k) { return k * q / ((n - k + 1) * p); });
+}
+
+///@return how many of 'n' drawn from 'total' soldiers are among 'marked' of them
+static int Hypergeometric(int total, int marked, int n)
+{
+	if (n <= 0 || marked <= 0)
+		return 0;
+	if (marked >= total)
+		return n;
+	if (n >= total)
+		return marked;
+
+	if (n < 16)
+	{
+		int k = 0;
+		for (int i = 0; i < n; ++i)
+			k += (getrandom(total - i) < marked - k);
+		return k;
+	}
+
+	const int other = total - marked;
+	const int lo = std::max(0, n - other);
+	const int hi = std::min(n, marked);
+	const int m = std::max(lo, std::min(hi, int((n + 1.0) * (marked + 1.0) / (total + 2.0))));
+	const double pm = exp(LogChoose(marked, m) + LogChoose(other, n - m) - LogChoose(total, n));
+	return FromMode(lo, hi, m, pm,
+	      [=](int k) { return double(marked - k) * (n - k) / ((k + 1.0) * (other - n + k + 1.0)); },
+	      [=](int k) { return double(k) * (other - n + k) / (double(marked - k + 1) * (n - k + 1)); });
+}
+
+//----------------------------------------------------------------------------
+///@return true if 'a' and 'b' fight identically
+static bool SameStats(const Soldier *a, const Soldier *b)
+{
+	if (a->unit != b->unit || a->race != b->race || a->hits != b->hits ||
+	    a->maxhits != b->maxhits || a->regen != b->regen ||
+	    a->weapon != b->weapon || a->armor != b->armor ||
+	    a->riding != b->riding || a->askill != b->askill ||
+	    a->attacks != b->attacks || a->amuletofi != b->amuletofi)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < NUM_ATTACK_TYPES; ++i)
+	{
+		if (a->dskill[i] != b->dskill[i])
+			return false;
+	}
+
+	return true;
+}
+
+CohortArmy::CohortArmy(Army *army)
+: army_(army)
+{
+	std::map<const Unit*, std::vector<int>> byUnit;
+	int last = -1;
+
+	for (int i = 0; i < army->notbehind; ++i)
+	{
+		Soldier *s = army->soldiers[i];
+		const int front = (i < army->canfront) ||
+		      (i >= army->canbehind && i < army->notfront);
+		const bool ready = (i < army->canbehind);
+
+		// soldiers of a unit are mostly built together, so try the last first
+		int found = -1;
+		if (last != -1 && cohorts_[last].front == front &&
+		    SameStats(cohorts_[last].model, s))
+		{
+			found = last;
+		}
+		else
+		{
+			for (int c : byUnit[s->unit])
+			{
+				if (cohorts_[c].front == front && SameStats(cohorts_[c].model, s))
+				{
+					found = c;
+					break;
+				}
+			}
+		}
+
+		if (found == -1)
+		{
+			found = cohorts_.size();
+			byUnit[s->unit].push_back(found);
+
+			Cohort c;
+			c.model = s;
+			c.front = front;
+			const int levels = std::max(s->hits, s->maxhits) + 1;
+			c.ready.assign(levels, 0);
+			c.done.assign(levels, 0);
+			c.nready = 0;
+			c.nalive = 0;
+			cohorts_.push_back(c);
+		}
+		last = found;
+
+		Cohort &c = cohorts_[found];
+		c.members.push_back(s);
+		++c.nalive;
+		++nalive_;
+		if (front)
+			++nfront_;
+
+		if (ready)
+		{
+			++c.ready[s->hits];
+			++c.nready;
+			++nready_;
+			if (front)
+				++nfrontready_;
+		}
+		else
+		{
+			++c.done[s->hits];
+		}
+	}
+}
+
+bool CohortArmy::Supports(const Army *army)
+{
+	// shields are raised by the specials ruled out below (see
+	// Battle::UpdateShields), but any already up would need DoAttack
+	if (army->shields.Num())
+		return false;
+
+	for (int i = 0; i < army->notbehind; ++i)
+	{
+		const Soldier *s = army->soldiers[i];
+		if (s->special != -1 || s->effects)
+			return false;
+
+		if (s->riding != -1 &&
+		    MountDefs[ItemDefs[s->riding].index].mountSpecial != -1)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+const Cohort* CohortArmy::GetAttacker(int i, int &behind)
+{
+	for (auto &c : cohorts_)
+	{
+		if (i >= c.nready)
+		{
+			i -= c.nready;
+			continue;
+		}
+
+		// pick a soldier, so each level of damage is as likely as its count
+		unsigned h = 1;
+		while (i >= c.ready[h])
+			i -= c.ready[h++];
+
+		--c.ready[h];
+		++c.done[h];
+		--c.nready;
+		--nready_;
+		if (c.front)
+			--nfrontready_;
+
+		SyncCounts();
+		behind = !c.front;
+		return &c;
+	}
+
+	return NULL;
+}
+
+int CohortArmy::FrontRank()
+{
+	// if front rank depleted, make behind units in front
+	if (!nfront_)
+	{
+		for (auto &c : cohorts_)
+		{
+			if (c.front)
+				continue;
+
+			c.front = 1;
+			nfront_ += c.nalive;
+			nfrontready_ += c.nready;
+		}
+	}
+
+	return nfront_;
+}
+
+Cohort* CohortArmy::GetTarget(int &hits, bool &ready)
+{
+	if (!FrontRank())
+		return NULL;
+
+	int i = getrandom(nfront_);
+	for (auto &c : cohorts_)
+	{
+		if (!c.front)
+			continue;
+
+		if (i >= c.nalive)
+		{
+			i -= c.nalive;
+			continue;
+		}
+
+		for (unsigned h = 1; h < c.ready.size(); ++h)
+		{
+			if (i < c.ready[h])
+			{
+				hits = h;
+				ready = true;
+				return &c;
+			}
+			i -= c.ready[h];
+
+			if (i < c.done[h])
+			{
+				hits = h;
+				ready = false;
+				return &c;
+			}
+			i -= c.done[h];
+		}
+	}
+
+	return NULL;
+}
+
+CohortOdds CohortArmy::AttackOdds(const Cohort *att, const Soldier *tar,
+      int attackType, int attackLevel, int flags, int weaponClass,
+      int mountBonus)
+{
+	CohortOdds odds;
+	odds.att = att;
+
+	int tarFlags = 0;
+	if (tar->weapon != -1)
+		tarFlags = WeaponDefs[ItemDefs[tar->weapon].index].flags;
+
+	int tlev = 0;
+	if (attackType != NUM_ATTACK_TYPES)
+		tlev = tar->dskill[attackType];
+
+	// check whether defense is allowed against this weapon
+	if ((flags & WeaponType::NODEFENSE) && tlev > 0)
+		tlev = 0;
+
+	if (!(flags & WeaponType::RANGED))
+	{
+		// check relative weapon length
+		int attLen = 1;
+		if (flags & WeaponType::LONG)
+			attLen = 2;
+		else if (flags & WeaponType::SHORT)
+			attLen = 0;
+
+		int defLen = 1;
+		if (tarFlags & WeaponType::LONG)
+			defLen = 2;
+		else if (tarFlags & WeaponType::SHORT)
+			defLen = 0;
+
+		if (attLen > defLen)
+			attackLevel++;
+		else if (defLen > attLen)
+			tlev++;
+	}
+
+	// add bonuses versus mounted
+	if (tar->riding != -1)
+		attackLevel += mountBonus;
+
+	odds.attackLevel = attackLevel;
+	odds.tlev = tlev;
+	odds.checkHit = (attackType != NUM_ATTACK_TYPES);
+	odds.checkReady = odds.checkHit && !(flags & WeaponType::ALWAYSREADY);
+	odds.saves = tar->ArmorChance(weaponClass, odds.from);
+
+	int tohit = 1, tomiss = 0;
+	if (odds.checkHit)
+		HitOdds(attackLevel, tlev, tohit, tomiss);
+
+	// readiness, hit and armor combined into one draw where the odds fit
+	long long num = tohit;
+	long long den = (long long)(tohit + tomiss) * (odds.checkReady ? 2 : 1);
+	if (odds.saves > 0)
+	{
+		const int saves = std::min(odds.saves, std::max(odds.from, 0));
+		num *= odds.from - saves;
+		den *= std::max(odds.from, 1);
+	}
+
+	odds.num = (den <= INT_MAX) ? num : 0;
+	odds.den = (den <= INT_MAX) ? den : 0;
+
+	// and as a chance, for volleys
+	odds.p = double(tohit) / (tohit + tomiss);
+	if (odds.checkReady)
+		odds.p /= 2;
+	if (odds.saves > 0)
+	{
+		const int saves = std::min(odds.saves, std::max(odds.from, 0));
+		odds.p *= double(odds.from - saves) / std::max(odds.from, 1);
+	}
+	return odds;
+}
+
+const CohortOdds& CohortArmy::GetOdds(const Cohort *att, Cohort *tar,
+      int attackType, int attackLevel, int flags, int weaponClass,
+      int mountBonus)
+{
+	for (const auto &o : tar->odds)
+	{
+		if (o.att == att)
+			return o;
+	}
+
+	tar->odds.push_back(AttackOdds(att, tar->model, attackType, attackLevel,
+	      flags, weaponClass, mountBonus));
+	return tar->odds.back();
+}
+
+void CohortArmy::DoAnAttack(const Cohort *att, int attackType, int attackLevel,
+      int flags, int weaponClass, int mountBonus)
+{
+	const int attack_bin = Army::AttackBin(attackType, att->model->riding != -1);
+
+	int hits;
+	bool ready;
+	Cohort *c = GetTarget(hits, ready);
+	if (!c)
+		return;
+
+	// the odds only depend on the two cohorts, so are worked out once
+	const CohortOdds *odds = &GetOdds(att, c, attackType, attackLevel, flags,
+	      weaponClass, mountBonus);
+
+	if (odds->den)
+	{
+		if (odds->num < odds->den && getrandom(odds->den) >= odds->num)
+			return;
+	}
+	else
+	{
+		if (odds->checkReady && getrandom(2))
+			return;
+		if (odds->checkHit && !Hits(odds->attackLevel, odds->tlev))
+			return;
+		if (odds->saves > 0 && odds->saves > getrandom(odds->from))
+			return;
+	}
+
+	const bool died = DamageSoldier(c, hits, ready);
+	++army_->hits_from[attack_bin];
+	if (died)
+		++army_->kills_from[attack_bin];
+
+	SyncCounts();
+}
+
+int CohortArmy::NumAttacks(const Cohort *c, int round, bool behind)
+{
+	const Soldier *a = c->model;
+
+	// from behind, only ranged weapons reach
+	if (behind && (a->weapon == -1 ||
+	    !(WeaponDefs[ItemDefs[a->weapon].index].flags & WeaponType::RANGED)))
+	{
+		return 0;
+	}
+
+	if (a->attacks < 0)
+		return (round % -a->attacks == 1) ? 1 : 0;
+
+	return a->attacks;
+}
+
+int CohortArmy::ReadyAttacks(int round) const
+{
+	int attacks = 0;
+	for (const auto &c : cohorts_)
+	{
+		if (c.nready)
+			attacks += c.nready * NumAttacks(&c, round, !c.front);
+	}
+	return attacks;
+}
+
+void CohortArmy::GetVolley(double q, std::vector<std::pair<const Cohort*, int>> &volley)
+{
+	for (auto &c : cohorts_)
+	{
+		const int n = Binomial(c.nready, q);
+		if (!n)
+			continue;
+
+		// which of them, by hits left
+		int left = n;
+		int pool = c.nready;
+		for (unsigned h = 1; h < c.ready.size() && left; ++h)
+		{
+			const int k = Hypergeometric(pool, c.ready[h], left);
+			pool -= c.ready[h];
+			c.ready[h] -= k;
+			c.done[h] += k;
+			left -= k;
+		}
+
+		c.nready -= n;
+		nready_ -= n;
+		if (c.front)
+			nfrontready_ -= n;
+
+		volley.push_back(std::make_pair(&c, n));
+	}
+
+	SyncCounts();
+}
+
+int CohortArmy::DoAttacks(const Cohort *att, int n, int attackType,
+      int attackLevel, int flags, int weaponClass, int mountBonus)
+{
+	const int attack_bin = Army::AttackBin(attackType, att->model->riding != -1);
+	const int total = n;
+
+	while (n > 0 && FrontRank())
+	{
+		// share the attacks among the front rank cohorts by their numbers,
+		// then roll each share at once
+		int rest = nfront_;
+		int again = 0; // hits on cohorts already dead aim again
+		for (auto &c : cohorts_)
+		{
+			if (!c.front || !c.nalive)
+				continue;
+
+			const int w = c.nalive;
+			const int x = (w >= rest) ? n : Binomial(n, double(w) / rest);
+			rest -= w;
+			n -= x;
+			if (!x)
+				continue;
+
+			const CohortOdds &odds = GetOdds(att, &c, attackType, attackLevel,
+			      flags, weaponClass, mountBonus);
+			again += DamageSoldiers(&c, Binomial(x, odds.p), attack_bin);
+			if (!n)
+				break;
+		}
+		n += again;
+	}
+
+	return total - n;
+}
+
+int CohortArmy::DamageSoldiers(Cohort *c, int n, int attackBin)
+{
+	if (!n)
+		return 0;
+
+	if (c->model->amuletofi)
+	{
+		army_->hits_from[attackBin] += n;
+		return 0;
+	}
+
+	if (c->ready.size() == 2)
+	{
+		// one hit kills, so the dead are any 'dead' of the cohort
+		const int dead = std::min(n, c->nalive);
+		const int ready = Hypergeometric(c->nalive, c->ready[1], dead);
+		c->ready[1] -= ready;
+		c->done[1] -= dead - ready;
+		c->nalive -= dead;
+		c->nready -= ready;
+		nalive_ -= dead;
+		nready_ -= ready;
+		if (c->front)
+		{
+			nfront_ -= dead;
+			nfrontready_ -= ready;
+		}
+
+		c->model->unit->losses += dead;
+		if (Globals->ARMY_ROUT == GameDefs::ARMY_ROUT_HITS_INDIVIDUAL)
+			army_->hitsalive -= dead;
+		else if (Globals->ARMY_ROUT == GameDefs::ARMY_ROUT_HITS_FIGURE)
+		{
+			const int race = c->model->race;
+			if (ItemDefs[race].type & IT_MONSTER)
+				army_->hitsalive -= dead * MonDefs[ItemDefs[race].index].hits;
+			else
+				army_->hitsalive -= dead * ManDefs[ItemDefs[race].index].hits;
+		}
+
+		army_->hits_from[attackBin] += dead;
+		army_->kills_from[attackBin] += dead;
+		SyncCounts();
+		return n - dead;
+	}
+
+	// otherwise hit one soldier at a time, each as likely as the next
+	for (; n > 0 && c->nalive; --n)
+	{
+		int i = getrandom(c->nalive);
+		unsigned h = 1;
+		bool ready = true;
+		for (;; ++h)
+		{
+			if (i < c->ready[h])
+				break;
+			i -= c->ready[h];
+
+			if (i < c->done[h])
+			{
+				ready = false;
+				break;
+			}
+			i -= c->done[h];
+		}
+
+		++army_->hits_from[attackBin];
+		if (DamageSoldier(c, h, ready))
+			++army_->kills_from[attackBin];
+	}
+
+	SyncCounts();
+	return n;
+}
+
+bool CohortArmy::DamageSoldier(Cohort *c, int hits, bool ready)
+{
+	if (c->model->amuletofi)
+		return false;
+
+	if (Globals->ARMY_ROUT == GameDefs::ARMY_ROUT_HITS_INDIVIDUAL)
+		--army_->hitsalive;
+
+	std::vector<int> &level = ready ? c->ready : c->done;
+	--level[hits];
+
+	// if soldier can take multiple hits
+	if (hits > 1)
+	{
+		++level[hits - 1];
+		return false;
+	}
+
+	// notify unit of loss
+	c->model->unit->losses++;
+
+	if (Globals->ARMY_ROUT == GameDefs::ARMY_ROUT_HITS_FIGURE)
+	{
+		const int race = c->model->race;
+		if (ItemDefs[race].type & IT_MONSTER)
+			army_->hitsalive -= MonDefs[ItemDefs[race].index].hits;
+		else
+			army_->hitsalive -= ManDefs[ItemDefs[race].index].hits;
+	}
+
+	--c->nalive;
+	--nalive_;
+	if (c->front)
+		--nfront_;
+
+	if (ready)
+	{
+		--c->nready;
+		--nready_;
+		if (c->front)
+			--nfrontready_;
+	}
+
+	return true;
+}
+
+void CohortArmy::Regenerate(Battle *b)
+{
+	for (auto &c : cohorts_)
+	{
+		const int regen = c.model->regen;
+		if (!regen)
+			continue;
+
+		const int maxhits = c.model->maxhits;
+		for (int h = maxhits - 1; h > 0; --h)
+		{
+			const int gain = (regen > maxhits - h) ? maxhits - h : regen;
+			for (std::vector<int> *level : {&c.ready, &c.done})
+			{
+				const int n = (*level)[h];
+				if (!n)
+					continue;
+
+				const AString line = *c.model->name + " regenerates " + gain +
+				      " hits bringing it to " + (h + gain) + "/" + maxhits + ".";
+				for (int i = 0; i < n; ++i)
+					b->AddLine(line);
+
+				(*level)[h + gain] += n;
+				(*level)[h] = 0;
+			}
+		}
+	}
+}
+
+void CohortArmy::Reset()
+{
+	for (auto &c : cohorts_)
+	{
+		for (unsigned h = 0; h < c.ready.size(); ++h)
+		{
+			c.ready[h] += c.done[h];
+			c.done[h] = 0;
+		}
+		c.nready = c.nalive;
+	}
+
+	nready_ = nalive_;
+	nfrontready_ = nfront_;
+	SyncCounts();
+}
+
+void CohortArmy::SyncCounts()
+{
+	army_->canfront = nfrontready_;
+	army_->canbehind = nready_;
+	army_->notfront = nready_ + nfront_ - nfrontready_;
+	army_->notbehind = nalive_;
+}
+
+void CohortArmy::WriteBack()
+{
+	// the army's ranks, in the order Army keeps them
+	std::vector<Soldier*> ranks[5];
+	enum { FRONT_READY, BEHIND_READY, FRONT_DONE, BEHIND_DONE, DEAD };
+
+	for (auto &c : cohorts_)
+	{
+		auto s = c.members.begin();
+		for (int h = c.ready.size() - 1; h > 0; --h)
+		{
+			for (int n = 0; n < c.ready[h]; ++n, ++s)
+			{
+				(*s)->hits = h;
+				ranks[c.front ? FRONT_READY : BEHIND_READY].push_back(*s);
+			}
+			for (int n = 0; n < c.done[h]; ++n, ++s)
+			{
+				(*s)->hits = h;
+				ranks[c.front ? FRONT_DONE : BEHIND_DONE].push_back(*s);
+			}
+		}
+
+		for (; s != c.members.end(); ++s)
+		{
+			(*s)->hits = 0;
+			ranks[DEAD].push_back(*s);
+		}
+	}
+
+	// soldiers dead before the cohorts were formed stay at the end
+	int x = 0;
+	for (auto &rank : ranks)
+	{
+		for (Soldier *s : rank)
+			army_->soldiers[x++] = s;
+	}
+
+	SyncCounts();
+}
+
+//----------------------------------------------------------------------------
+// Battle rounds for cohort armies.  These follow FreeRound, NormalRound and
+// DoAttack, without the parts Supports rules out (shields, specials and
+// one shot effects).  While the armies are large they fight in volleys:
+// the soldiers' turns to attack come in a random order, so the ones whose
+// turn falls in the next slice of the round are a random share of those
+// yet to attack, the same share of each cohort.
+void Battle::CohortFreeRound(Army *att, Army *def)
+{
+	AddLine(*att->leader->faction->name + " gets a free round of attacks.");
+
+	att->round++;
+
+	// volleys while the armies are large enough, then one at a time (as the
+	// armies only shrink, there is no need to try volleys again)
+	bool volleys = true;
+	while (att->CanAttack() && def->NumAlive())
+	{
+		if (volleys)
+			volleys = CohortVolley(att, def, false);
+		if (volleys)
+			continue;
+
+		int num = getrandom(att->CanAttack());
+		int behind;
+		const Cohort *c = att->cohorts->GetAttacker(num, behind);
+		CohortAttack(att->round, c, def, behind);
+	}
+
+	def->cohorts->Regenerate(this);
+
+	def->endRound(this);
+	AddLine("");
+
+	att->cohorts->Reset();
+}
+
+void Battle::CohortNormalRound(int round, Army *a, Army *b)
+{
+	AddLine(AString("Round ") + round + ":");
+
+	a->round++;
+	b->round++;
+
+	int aatt = a->CanAttack();
+	int batt = b->CanAttack();
+
+	// (as in CohortFreeRound)
+	bool volleys = true;
+	while (a->NumAlive() && b->NumAlive() && (aatt || batt))
+	{
+		if (volleys)
+			volleys = CohortVolley(a, b, true);
+		if (!volleys)
+		{
+			int num = getrandom(aatt + batt);
+			int behind;
+			if (num >= aatt)
+			{
+				const Cohort *c = b->cohorts->GetAttacker(num - aatt, behind);
+				CohortAttack(b->round, c, a, behind);
+			}
+			else
+			{
+				const Cohort *c = a->cohorts->GetAttacker(num, behind);
+				CohortAttack(a->round, c, b, behind);
+			}
+		}
+
+		aatt = a->CanAttack();
+		batt = b->CanAttack();
+	}
+
+	a->cohorts->Regenerate(this);
+	b->cohorts->Regenerate(this);
+
+	a->endRound(this);
+	b->endRound(this);
+
+	AddLine("");
+
+	a->cohorts->Reset();
+	b->cohorts->Reset();
+}
+
+void Battle::CohortAttack(int round, const Cohort *c, Army *def, int behind, int n)
+{
+	const Soldier *a = c->model;
+	const int numAttacks = CohortArmy::NumAttacks(c, round, behind);
+	if (!numAttacks)
+		return;
+
+	WeaponType *pWep = NULL;
+	if (a->weapon != -1)
+		pWep = &WeaponDefs[ItemDefs[a->weapon].index];
+
+	int flags = WeaponType::SHORT;
+	int attackType = ATTACK_COMBAT;
+	int mountBonus = 0;
+	int attackClass = SLASHING;
+	if (pWep)
+	{
+		flags = pWep->flags;
+		attackType = pWep->attackType;
+		mountBonus = pWep->mountBonus;
+		attackClass = pWep->weapClass;
+	}
+
+	// the attacks of a volley are resolved together
+	if (n > 1)
+	{
+		attacks += def->cohorts->DoAttacks(c, n * numAttacks, attackType,
+		      a->askill, flags, attackClass, mountBonus);
+		return;
+	}
+
+	for (int i = 0; i < numAttacks; ++i)
+	{
+		++attacks;
+		def->cohorts->DoAnAttack(c, attackType, a->askill, flags,
+		      attackClass, mountBonus);
+
+		if (!def->NumAlive())
+			break;
+	}
+}
+
+bool Battle::CohortVolley(Army *a, Army *b, bool both)
+{
+	CohortArmy *ac = a->cohorts;
+	CohortArmy *bc = b->cohorts;
+
+	// the attacks each side would make if all its soldiers yet to attack did
+	const double aAttacks = ac->ReadyAttacks(a->round);
+	const double bAttacks = both ? bc->ReadyAttacks(b->round) : 0;
+
+	// take a share of them small enough that neither front rank loses much
+	// to the volley
+	double q = 1;
+	if (aAttacks > 0)
+		q = std::min(q, bc->NumTargets() / (VOLLEY_SHARE * aAttacks));
+	if (bAttacks > 0)
+		q = std::min(q, ac->NumTargets() / (VOLLEY_SHARE * bAttacks));
+	if (q * (aAttacks + bAttacks) < VOLLEY_MIN)
+		return false;
+
+	// the two sides' turns are interleaved, so on average half of either
+	// side's volley comes after the other's: firing them in a random order
+	// loses that half of the second to the first, on average
+	Army *sides[2] = {a, b};
+	const int first = both ? getrandom(2) : 0;
+	std::vector<std::pair<const Cohort*, int>> volley;
+	for (int i = 0; i < (both ? 2 : 1); ++i)
+	{
+		Army *att = sides[first ^ i];
+		Army *def = sides[first ^ i ^ 1];
+		if (!att->NumAlive() || !def->NumAlive())
+			break;
+
+		volley.clear();
+		att->cohorts->GetVolley(q, volley);
+		for (const auto &v : volley)
+		{
+			if (def->NumAlive())
+				CohortAttack(att->round, v.first, def, !v.first->front, v.second);
+		}
+	}
+
+	return true;
+}
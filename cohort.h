@@ -0,0 +1,167 @@
+#ifndef COHORT_CLASS
+#define COHORT_CLASS
+// START A3HEADER
+//
+// This source file is part of the Atlantis PBM game program.
+// Copyright (C) 1995-1999 Geoff Dunbar
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program, in the file license.txt. If not, write
+// to the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+// Boston, MA 02111-1307, USA.
+//
+// See the Atlantis Project web page for details:
+// http://www.prankster.com/project
+//
+// END A3HEADER
+#include <vector>
+class Army;
+class Battle;
+class Soldier;
+
+struct Cohort;
+
+//----------------------------------------------------------------------------
+/// Odds of an attack from one cohort getting through to a soldier of another
+struct CohortOdds
+{
+	const Cohort *att; ///< the attacking cohort
+	int num; ///< the attack gets through 'num' times in 'den'
+	int den; ///< 0 if too fine for one draw: roll each step as Army does
+
+	int attackLevel; ///< attack level, after weapon length and mounts
+	int tlev;        ///< defense level
+	bool checkHit;   ///< roll attackLevel against tlev
+	bool checkReady; ///< roll whether the weapon is ready
+	int saves;       ///< armor stops the attack 'saves' times in 'from'
+	int from;
+	double p;        ///< chance the attack gets through, for volleys
+};
+
+//----------------------------------------------------------------------------
+/// Soldiers of one army with identical combat stats, counted together
+struct Cohort
+{
+	std::vector<Soldier*> members; ///< the soldiers, updated by WriteBack
+	const Soldier *model; ///< combat stats shared by all members
+	int front; ///< 1 if in the front rank
+
+	std::vector<int> ready; ///< number yet to attack this round, by hits left
+	std::vector<int> done;  ///< number that have attacked, by hits left
+	int nready;
+	int nalive;
+
+	std::vector<CohortOdds> odds; ///< attacks on this cohort, worked out once
+};
+
+//----------------------------------------------------------------------------
+/// An army fought as counted cohorts rather than single soldiers
+/// (optional engine for huge stacks, see GameDefs::COHORT_BATTLES).
+/// Soldiers in a cohort are interchangeable, so drawing a cohort weighted by
+/// its count picks attackers and targets with the same odds as drawing one
+/// soldier from the whole army.  Large armies fight in volleys, in which
+/// every soldier yet to attack does so with the same chance, and each
+/// cohort's attacks on each target cohort are rolled as one binomial draw.
+class CohortArmy
+{
+public:
+	/// group the living soldiers of 'army'
+	explicit CohortArmy(Army *army);
+
+	///@return true if no soldier of 'army' needs the per-soldier rules
+	/// (specials, spells, mount specials)
+	static bool Supports(const Army *army);
+
+	///@return number of soldiers yet to attack this round
+	int CanAttack() const { return nready_; }
+
+	///@return number of soldiers alive
+	int NumAlive() const { return nalive_; }
+
+	///@return number of soldiers that can be attacked: the front rank, or
+	/// the rear once the front is gone
+	int NumTargets() const { return nfront_ ? nfront_ : nalive_; }
+
+	///@return normal attacks a soldier of 'c' makes in 'round'
+	static int NumAttacks(const Cohort *c, int round, bool behind);
+
+	///@return normal attacks the soldiers yet to attack would make in 'round'
+	int ReadyAttacks(int round) const;
+
+	/// take the 'i'th soldier yet to attack, setting 'behind' if in the rear
+	///@return its cohort
+	const Cohort* GetAttacker(int i, int &behind);
+
+	/// take each soldier yet to attack with chance 'q', adding how many of
+	/// each cohort were taken to 'volley'
+	void GetVolley(double q, std::vector<std::pair<const Cohort*, int>> &volley);
+
+	/// resolve one normal attack by a soldier of 'att' on this army
+	void DoAnAttack(const Cohort *att, int attackType, int attackLevel,
+	      int flags, int weaponClass, int mountBonus);
+
+	/// resolve 'n' normal attacks by soldiers of 'att' on this army
+	///@return number of attacks made before the army was wiped out
+	int DoAttacks(const Cohort *att, int n, int attackType, int attackLevel,
+	      int flags, int weaponClass, int mountBonus);
+
+	/// apply regeneration at the end of a round, reporting to 'b'
+	void Regenerate(Battle *b);
+
+	/// start a new round: every living soldier may attack again
+	void Reset();
+
+	/// copy the counts into the army's soldiers and rank counters
+	void WriteBack();
+
+private:
+	///@return odds of an attack from 'att' getting through to 'tar'
+	static CohortOdds AttackOdds(const Cohort *att, const Soldier *tar,
+	      int attackType, int attackLevel, int flags, int weaponClass,
+	      int mountBonus);
+
+	///@return odds of an attack from 'att' getting through to 'tar',
+	/// worked out once per pair of cohorts
+	static const CohortOdds& GetOdds(const Cohort *att, Cohort *tar,
+	      int attackType, int attackLevel, int flags, int weaponClass,
+	      int mountBonus);
+
+	///@return number of soldiers in the front rank, moving the rear rank up
+	/// first if the front is empty
+	int FrontRank();
+
+	///@return a random front rank target, or NULL if none is left
+	Cohort* GetTarget(int &hits, bool &ready);
+
+	/// damage a soldier of 'c' with 'hits' left
+	///@return true if he dies
+	bool DamageSoldier(Cohort *c, int hits, bool ready);
+
+	/// damage 'n' random soldiers of 'c' in turn, counting the hits under
+	/// 'attackBin'
+	///@return number of hits left over when the whole cohort is dead
+	int DamageSoldiers(Cohort *c, int n, int attackBin);
+
+	/// update the army's rank counters (used by Broken, NumAlive, ...)
+	void SyncCounts();
+
+private:
+	Army *army_;
+	std::vector<Cohort> cohorts_;
+	int nready_ = 0;
+	int nalive_ = 0;
+	int nfront_ = 0;      ///< living soldiers in the front rank
+	int nfrontready_ = 0; ///< front rank soldiers yet to attack
+};
+
+#endif
@@ -1148,7 +1148,7 @@ void Faction::WriteReport(Areport *f, Game *pGame)
 		}
 		deleteAll(errors_);
 		events.DeleteAll();
-		battles.DeleteAll();
+		battles.clear();
 		return;
 	}
 
@@ -1273,13 +1273,12 @@ void Faction::WriteReport(Areport *f, Game *pGame)
 		f->EndLine();
 	}
 
-	if (battles.Num())
+	if (!battles.empty())
 	{
 		f->PutStr("Battles during turn:");
-		forlist(&battles) {
-			((BattlePtr*)elem)->ptr->Report(f, this);
-		}
-		battles.DeleteAll();
+		for (const auto &battle : battles)
+			battle->Report(f);
+		battles.clear();
 	}
 
 	if (events.Num())
@@ -1447,6 +1446,12 @@ void Faction::Error(const AString &s)
 	if (IsNPC())
 		return;
 
+	if (FactionLog *log = FactionLog::Current())
+	{
+		log->Add([this, s] { Error(s); });
+		return;
+	}
+
 	if (errors_.size() > 1000)
 	{
 		if (errors_.size() == 1001)
@@ -1461,8 +1466,16 @@ void Faction::Error(const AString &s)
 
 void Faction::Event(const AString &s)
 {
-	if (!IsNPC())
-		events.Add(new AString(s));
+	if (IsNPC())
+		return;
+
+	if (FactionLog *log = FactionLog::Current())
+	{
+		log->Add([this, s] { Event(s); });
+		return;
+	}
+
+	events.Add(new AString(s));
 }
 
 void Faction::RemoveAttitude(int f)
@@ -1661,6 +1674,12 @@ Faction* GetFaction2(AList *facs, int n)
 
 void Faction::DiscoverItem(int item, int force, int full)
 {
+	if (FactionLog *log = FactionLog::Current())
+	{
+		log->Add([=] { DiscoverItem(item, force, full); });
+		return;
+	}
+
 	const int seen = items.GetNum(item);
 	if (!seen)
 	{
@@ -1693,3 +1712,22 @@ void Faction::DiscoverItem(int item, int force, int full)
 	if (force)
 		itemshows.Add(ItemDescription(item, full));
 }
+
+static thread_local FactionLog *current_log = nullptr;
+
+void FactionLog::Use(FactionLog *log)
+{
+	current_log = log;
+}
+
+FactionLog* FactionLog::Current()
+{
+	return current_log;
+}
+
+void FactionLog::Apply()
+{
+	for (auto &change : changes_)
+		change();
+	changes_.clear();
+}
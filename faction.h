@@ -28,7 +28,9 @@
 #include "skills.h"
 #include "helper.h"
 #include "alist.h"
+#include <functional>
 #include <list>
+#include <memory>
 #include <vector>
 
 class Ainfile;
@@ -37,6 +39,7 @@ class ARegion;
 class ARegionList;
 class Areport;
 class AString;
+class BattleText;
 class Faction;
 class Game;
 class Unit;
@@ -107,6 +110,25 @@ public:
 	Faction *ptr;
 };
 
+/// Faction changes held back while battles are fought on worker threads.
+/// While a log is in use on a thread, errors, events, item discoveries and
+/// battle reports for any faction go into it, to be made later by Apply
+class FactionLog
+{
+public:
+	/// hold this thread's faction changes in 'log' (nullptr: make them at once)
+	static void Use(FactionLog *log);
+	///@return the log in use on this thread, or nullptr
+	static FactionLog* Current();
+
+	void Add(std::function<void()> change) { changes_.push_back(std::move(change)); }
+	/// make the held changes, in the order they were added
+	void Apply();
+
+private:
+	std::vector<std::function<void()>> changes_;
+};
+
 /// toplevel container for one player to control
 class Faction : public AListElem
 {
@@ -202,7 +224,7 @@ public: // data
 	std::list<AString*> extraPlayers_;
 	std::vector<AString*> errors_;
 	AList events;
-	AList battles;
+	std::vector<std::shared_ptr<const BattleText>> battles;
 	AList shows;
 	AList itemshows;
 	AList objectshows;
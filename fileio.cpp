@@ -25,9 +25,76 @@
 #include "fileio.h"
 #include "gameio.h"
 #include "astring.h"
+#include <stdlib.h>
+#include <string.h>
+#include <string>
 
 static char buf[1024];
 
+namespace
+{
+// Binary save format: a header, then one record per PutInt/PutStr, in the
+// same order as the text format writes lines.  A record is a tag byte and
+// a zigzag varint (for strings, the length followed by the characters).
+const char BIN_MAGIC[] = { '\0', 'A', 'T', 'L', 'B' }; // text never starts with NUL
+const unsigned BIN_VERSION = 1;
+const int BIN_INT = 'i';
+const int BIN_STR = 's';
+
+std::string binbuf;
+
+void putVarint(std::streambuf *sb, int x)
+{
+	unsigned v = (unsigned(x) << 1) ^ unsigned(x >> 31); // zigzag
+	while (v >= 0x80)
+	{
+		sb->sputc(char(v | 0x80));
+		v >>= 7;
+	}
+	sb->sputc(char(v));
+}
+
+int getVarint(std::streambuf *sb)
+{
+	unsigned v = 0;
+	for (int shift = 0; shift < 35; shift += 7)
+	{
+		const int ch = sb->sbumpc();
+		if (ch == std::char_traits<char>::eof())
+			break;
+
+		v |= unsigned(ch & 0x7f) << shift;
+		if (!(ch & 0x80))
+			break;
+	}
+	return int(v >> 1) ^ -int(v & 1);
+}
+
+/// read the rest of the record with 'tag' into binbuf, @return false at end of file
+bool getRecord(std::streambuf *sb, int tag)
+{
+	if (tag == BIN_INT)
+	{
+		binbuf = std::to_string(getVarint(sb));
+		return true;
+	}
+
+	if (tag != BIN_STR)
+		return false;
+
+	const int len = getVarint(sb);
+	binbuf.resize(len > 0 ? len : 0);
+	if (len > 0)
+		binbuf.resize(sb->sgetn(&binbuf[0], len));
+	return true;
+}
+
+bool isWhite(char ch)
+{
+	return ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r' || ch == '\0';
+}
+} // anonymous namespace
+
 static void skipwhite(std::ifstream *f)
 {
 	if (f->eof())
@@ -56,19 +123,52 @@ Ainfile::~Ainfile()
 	delete file;
 }
 
+void Ainfile::openFile(const char *name)
+{
+	binary_ = false;
+	file->open(name, std::ios::in|std::ios::binary);
+	if (!file->rdbuf()->is_open())
+		return;
+
+	if (file->peek() != BIN_MAGIC[0])
+	{
+		// reopen in text mode, for the line endings
+		file->close();
+		file->open(name, std::ios::in);
+		return;
+	}
+
+	char magic[sizeof(BIN_MAGIC)];
+	file->read(magic, sizeof(magic));
+	if (file->gcount() != sizeof(magic) ||
+	    memcmp(magic, BIN_MAGIC, sizeof(magic)) != 0)
+	{
+		Awrite(AString("Unrecognized file format: ") + name);
+		file->setstate(std::ios::failbit);
+		return;
+	}
+
+	binary_ = true;
+	if (unsigned(getVarint(file->rdbuf())) != BIN_VERSION)
+	{
+		Awrite(AString("Unsupported binary file version: ") + name);
+		file->setstate(std::ios::failbit);
+	}
+}
+
 void Ainfile::Open(const AString &s)
 {
 	while (!file->rdbuf()->is_open())
 	{
 		AString *name = getfilename(s);
-		file->open(name->str(), std::ios::in);
+		openFile(name->str());
 		delete name;
 	}
 }
 
 int Ainfile::OpenByName(const AString &s)
 {
-	file->open(s.str(), std::ios::in);
+	openFile(s.str());
 
 	if (!file->rdbuf()->is_open())
 		return -1;
@@ -83,12 +183,35 @@ void Ainfile::Close()
 
 AString* Ainfile::GetStr()
 {
+	if (binary_)
+	{
+		// skip blank records and leading white, as for text
+		while (file->good() && getRecord(file->rdbuf(), file->rdbuf()->sbumpc()))
+		{
+			size_t i = 0;
+			while (i < binbuf.size() && isWhite(binbuf[i]))
+				++i;
+
+			if (i < binbuf.size())
+				return new AString(binbuf.c_str() + i);
+		}
+		return 0;
+	}
+
 	skipwhite(file);
 	return GetStrNoSkip();
 }
 
 AString* Ainfile::GetStrNoSkip()
 {
+	if (binary_)
+	{
+		if (!file->good() || !getRecord(file->rdbuf(), file->rdbuf()->sbumpc()))
+			return 0;
+
+		return new AString(binbuf.c_str());
+	}
+
 	if (file->peek() == -1 || file->eof())
 		return 0;
 
@@ -98,6 +221,22 @@ AString* Ainfile::GetStrNoSkip()
 
 int Ainfile::GetInt()
 {
+	if (binary_)
+	{
+		if (!file->good())
+			return 0;
+
+		std::streambuf *sb = file->rdbuf();
+		const int tag = sb->sbumpc();
+		if (tag == BIN_INT)
+			return getVarint(sb);
+
+		if (!getRecord(sb, tag))
+			return 0;
+
+		return atoi(binbuf.c_str());
+	}
+
 	int x = 0;
 	*file >> x;
 	return x;
@@ -116,6 +255,7 @@ Aoutfile::~Aoutfile()
 
 void Aoutfile::Open(const AString &s)
 {
+	binary_ = false;
 	while (!file->rdbuf()->is_open())
 	{
 		AString *name = getfilename(s);
@@ -130,9 +270,13 @@ void Aoutfile::Open(const AString &s)
 	}
 }
 
-int Aoutfile::OpenByName(const AString &s)
+int Aoutfile::OpenByName(const AString &s, bool binary)
 {
-	file->open(s.str(), std::ios::out|std::ios::ate);
+	std::ios::openmode mode = std::ios::out|std::ios::ate;
+	if (binary)
+		mode |= std::ios::binary;
+
+	file->open(s.str(), mode);
 	if (!file->rdbuf()->is_open())
 		return -1;
 
@@ -144,6 +288,13 @@ int Aoutfile::OpenByName(const AString &s)
 		file->close();
 		return -1;
 	}
+
+	binary_ = binary;
+	if (binary_)
+	{
+		file->write(BIN_MAGIC, sizeof(BIN_MAGIC));
+		putVarint(file->rdbuf(), BIN_VERSION);
+	}
 	return 0;
 }
 
@@ -154,22 +305,45 @@ void Aoutfile::Close()
 
 void Aoutfile::PutInt(int x)
 {
+	if (binary_)
+	{
+		std::streambuf *sb = file->rdbuf();
+		sb->sputc(BIN_INT);
+		putVarint(sb, x);
+		return;
+	}
+
 	*file << x << '\n';
 }
 
-void Aoutfile::PutStr(const char *s)
+void Aoutfile::putStr(const char *s, int len)
 {
-	*file << s << '\n';
+	std::streambuf *sb = file->rdbuf();
+	sb->sputc(BIN_STR);
+	putVarint(sb, len);
+	sb->sputn(s, len);
 }
 
-void Aoutfile::PutStr(const AString &s)
+void Aoutfile::PutStr(const char *s)
 {
+	if (binary_)
+	{
+		putStr(s, strlen(s));
+		return;
+	}
+
 	*file << s << '\n';
 }
 
-void Aoutfile::putNoNewline(const char *s)
+void Aoutfile::PutStr(const AString &s)
 {
-	*file << s;
+	if (binary_)
+	{
+		putStr(s.str(), s.len());
+		return;
+	}
+
+	*file << s << '\n';
 }
 
 //----------------------------------------------------------------------------
@@ -178,18 +352,40 @@ Areport::Areport()
 {
 }
 
+Areport::~Areport()
+{
+	flush();
+}
+
 void Areport::Open(const AString &s)
 {
 	Aoutfile::Open(s);
 	tabs = 0;
+	out_.clear();
 }
 
 int Areport::OpenByName(const AString &s)
 {
 	tabs = 0;
+	out_.clear();
 	return Aoutfile::OpenByName(s);
 }
 
+void Areport::flush()
+{
+	if (out_.empty())
+		return;
+
+	file->write(out_.data(), out_.size());
+	out_.clear();
+}
+
+void Areport::Close()
+{
+	flush();
+	Aoutfile::Close();
+}
+
 void Areport::AddTab()
 {
 	++tabs;
@@ -208,44 +404,80 @@ void Areport::ClearTab()
 
 void Areport::PutStr(const AString &s, int comment)
 {
-	AString temp;
-	for (int i = 0; i < tabs; ++i)
-		temp += "  ";
+	Wrap(out_, s, tabs, comment);
+}
 
-	temp += s;
-	AString *temp2 = temp.Trunc(70);
+void Areport::PutWrapped(const std::string &text)
+{
+	out_ += text;
+}
 
-	if (comment)
-		Aoutfile::putNoNewline(";");
+void Areport::Wrap(std::string &out, const AString &s, int tabs, int comment)
+{
+	const int width = 70; // wrap lines longer than this
+	const int back = 30;  // how far back to look for a space to wrap at
 
-	Aoutfile::PutStr(temp);
+	// each line is 'indent' spaces then 'len' chars of 'text'
+	int indent = 2 * tabs;
+	const char *text = s.str();
+	int len = s.len();
 
-	while (temp2)
+	for (;;)
 	{
-		temp = "  ";
-		for (int i = 0; i < tabs; ++i)
-			temp += "  ";
+		// where this line ends, and the rest begins
+		int cut = indent + len;
+		int rest = -1;
+		if (cut > width)
+		{
+			cut = rest = width;
+			for (int i = width; i > width - back; --i)
+			{
+				if (i < indent || text[i - indent] == ' ')
+				{
+					cut = i;
+					rest = i + 1;
+					break;
+				}
+			}
+		}
 
-		temp += *temp2;
+		if (comment)
+			out += ';';
 
-		delete temp2;
-		temp2 = temp.Trunc(70);
+		const int spaces = cut < indent ? cut : indent;
+		out.append(spaces, ' ');
+		if (cut > indent)
+			out.append(text, strnlen(text, cut - indent));
+		out += '\n';
 
-		if (comment)
-			Aoutfile::putNoNewline(";");
+		if (rest == -1)
+			return;
 
-		Aoutfile::PutStr(temp);
+		// the rest goes on the next line, indented one more
+		if (rest <= indent)
+		{
+			indent -= rest;
+		}
+		else
+		{
+			text += rest - indent;
+			len -= rest - indent;
+			indent = 0;
+		}
+		len = strnlen(text, len);
+		indent += 2 + 2 * tabs;
 	}
 }
 
 void Areport::PutNoFormat(const AString &s)
 {
-	Aoutfile::PutStr(s);
+	out_ += s.str();
+	out_ += '\n';
 }
 
 void Areport::EndLine()
 {
-	Aoutfile::PutStr("");
+	out_ += '\n';
 }
 
 //----------------------------------------------------------------------------
@@ -26,9 +26,10 @@
 // END A3HEADER
 #include <fstream>
 #include <iostream>
+#include <string>
 class AString;
 
-/// a file for reading
+/// a file for reading (text, or binary if it starts with the binary header)
 class Ainfile
 {
 public:
@@ -39,12 +40,19 @@ public:
 	int OpenByName(const AString&);
 	void Close();
 
+	///@return true if the file is in the compact binary format
+	bool isBinary() const { return binary_; }
+
 	AString* GetStr();
 	AString* GetStrNoSkip();
 	int GetInt();
 
+private:
+	void openFile(const char *name);
+
 private:
 	std::ifstream *file;
+	bool binary_ = false;
 };
 
 /// a file for writing
@@ -55,17 +63,22 @@ public:
 	~Aoutfile();
 
 	void Open(const AString&);
-	int OpenByName(const AString&);
+	/// open a new file, writing the compact binary format if 'binary'
+	int OpenByName(const AString&, bool binary = false);
 	void Close();
 
 	void PutStr(const char*);
 	void PutStr(const AString&);
 	void PutInt(int);
 
-	void putNoNewline(const char*);
-
 protected:
 	std::ofstream *file;
+
+private:
+	void putStr(const char*, int len);
+
+private:
+	bool binary_ = false;
 };
 
 /// Orders files are inputs
@@ -75,14 +88,16 @@ public:
 	AString* GetLine() { return GetStr(); }
 };
 
-/// Reports are outputs
+/// Reports are outputs (collected in memory, and written out on Close)
 class Areport : public Aoutfile
 {
 public:
 	Areport();
+	~Areport();
 
 	void Open(const AString&);
 	int OpenByName(const AString&);
+	void Close();
 
 	void AddTab();
 	void DropTab();
@@ -92,8 +107,18 @@ public:
 	void PutNoFormat(const AString&);
 	void EndLine();
 
+	/// add 'text' which was already formatted by Wrap()
+	void PutWrapped(const std::string &text);
+
+	/// format 's' as PutStr does at 'tabs', onto the end of 'out'
+	static void Wrap(std::string &out, const AString &s, int tabs, int comment = 0);
+
+private:
+	void flush();
+
 private:
 	int tabs;
+	std::string out_; ///< report text not yet written (reused between files)
 };
 
 /// Rules are outputs (HTML)
@@ -32,11 +32,11 @@
 #include "object.h"
 #include "orders.h"
 
-#ifdef WIN32
-#include <memory.h>  // Needed for memcpy on windows
-#endif
 #include <string.h>
+#include <atomic>
 #include <memory>
+#include <thread>
+#include <vector>
 
 Game::Game()
 {
@@ -44,9 +44,6 @@ Game::Game()
 
 Game::~Game()
 {
-	delete[] ppUnits;
-	ppUnits = 0;
-	maxppunits = 0;
 }
 
 void Game::resolveBackRefs()
@@ -386,6 +383,9 @@ int Game::OpenGame()
 	if (f.OpenByName("game.in") == -1)
 		return 0;
 
+	if (!saveFormatSet)
+		binarySave = f.isBinary();
+
 	// Read in Globals
 	std::unique_ptr<AString> s1(f.GetStr());
 	if (!s1)
@@ -484,7 +484,8 @@ int Game::OpenGame()
 	}
 
 	month = f.GetInt();
-	seedrandom(f.GetInt());
+	randomSeed = f.GetInt();
+	seedrandom(randomSeed);
 	factionseq = f.GetInt();
 	unitseq = f.GetInt();
 	shipseq = f.GetInt();
@@ -601,7 +602,7 @@ int Game::OpenGame()
 int Game::SaveGame()
 {
 	Aoutfile f;
-	if (f.OpenByName("game.out") == -1)
+	if (f.OpenByName("game.out", binarySave) == -1)
 		return 0;
 
 	// Write out Globals
@@ -831,9 +832,6 @@ Unit* Game::ParseGMUnit(AString *tag, Faction *pFac)
 	if (*str != 'g' || *(str+1) != 'm')
 	{
 		const int v = tag->value();
-		if (unsigned(v) >= maxppunits)
-			return nullptr; // beyond end of unit vec
-
 		return GetUnit(v);
 	}
 	// else find gm added unit
@@ -1304,10 +1302,15 @@ int Game::RunGame()
 	Awrite("Running the Turn...");
 	RunOrders();
 
+	if (Globals->BATTLE_PROFILE)
+	{
+		Awrite("Writing the Battle Profile...");
+		WriteBattleProfile();
+	}
+
 	Awrite("Writing the Report File...");
 	WriteReport();
 	Awrite("");
-	battles.DeleteAll();
 
 	Awrite("Writing Playerinfo File...");
 	WritePlayers();
@@ -1320,6 +1323,14 @@ int Game::RunGame()
 	return 1;
 }
 
+std::unique_ptr<RandomStream> Game::TakeStream(std::initializer_list<unsigned> key)
+{
+	if (!Globals->RANDOM_STREAMS)
+		return nullptr; // one stream, in the order the game has always used
+
+	return std::unique_ptr<RandomStream>(new RandomStream(randomSeed, key));
+}
+
 int Game::EditGame(int *pSaveGame)
 {
 	*pSaveGame = 0;
@@ -1678,6 +1689,7 @@ void Game::MakeFactionReportLists()
 	forlist(&regions)
 	{
 		ARegion *reg = (ARegion*)elem;
+		reg->SetupVision();
 
 		vector.ClearVector(); // reset the vector
 
@@ -1727,26 +1739,62 @@ void Game::WriteReport()
 	if (Globals->APPRENTICES_EXIST)
 		CountAllApprentices();
 
-	Areport f; // avoid loop overhead
-
+	// factions which get a report
+	std::vector<Faction*> reportFacs;
 	forlist(&factions)
 	{
 		Faction *fac = (Faction*)elem;
-		const AString str = AString("report.") + fac->num;
-
 		if (!fac->IsNPC() ||
 		    (((month == 0 && year == 1) || Globals->GM_REPORT) &&
 		     fac->num == 1)
 		   )
 		{
-			const int i = f.OpenByName(str);
-			if (i == -1)
+			reportFacs.push_back(fac);
+		}
+	}
+
+	// a report only changes its own faction (and that faction's units'
+	// orders), so each worker takes the next faction and writes its file
+	std::atomic<unsigned> next(0);
+	auto writeReports = [this, &reportFacs, &next]()
+	{
+		Areport f; // avoid loop overhead
+
+		for (unsigned i = next++; i < reportFacs.size(); i = next++)
+		{
+			Faction *fac = reportFacs[i];
+			const int err = f.OpenByName(AString("report.") + fac->num);
+			if (err == -1)
 				continue; // failed to open!
 
 			fac->WriteReport(&f, this);
 			f.Close();
+			Adot();
+		}
+	};
+
+	if (reportThreads == 1)
+	{
+		writeReports();
+	}
+	else
+	{
+		// reports ask units for their stats, so have the caches filled
+		// here rather than by several workers at once
+		forlist(&regions)
+		{
+			ARegion *r = (ARegion*)elem;
+			r->applyToUnits([](Unit *u) { u->FillStats(); });
 		}
-		Adot();
+
+		std::vector<std::thread> pool;
+		for (int i = 1; i < reportThreads; ++i)
+			pool.emplace_back(writeReports);
+
+		writeReports();
+
+		for (auto &t : pool)
+			t.join();
 	}
 }
 
@@ -1874,14 +1922,10 @@ void Game::SetupUnitNums()
 {
 	SetupUnitSeq(); // capture max unit num into this->unitseq
 
-	maxppunits = unitseq+10000;
+	const unsigned maxppunits = unitseq+10000;
 
 	// rebuild pointer to pointers of units
-	delete[] ppUnits;
-	ppUnits = new Unit *[ maxppunits ];
-
-	for (unsigned i = 0; i < maxppunits ; ++i)
-		ppUnits[i] = nullptr;
+	ppUnits.assign(maxppunits, nullptr);
 
 	forlist(&regions)
 	{
@@ -1920,15 +1964,23 @@ void Game::SetupUnitNums()
 			}
 		}
 	}
+
+	// collect the holes left by units which died last turn
+	unitHoles = decltype(unitHoles)();
+	for (unsigned i = 1; i < unitseq; ++i)
+	{
+		if (!ppUnits[i])
+			unitHoles.push(i);
+	}
 }
 
 Unit* Game::GetNewUnit(Faction *fac, int an)
 {
-	// look for a hole
-	for (unsigned i = 1; i < unitseq; ++i)
+	// reuse the smallest hole
+	if (!unitHoles.empty())
 	{
-		if (ppUnits[i])
-			continue;
+		const unsigned i = unitHoles.top();
+		unitHoles.pop();
 
 		Unit *pUnit = new Unit(i, fac, an);
 		ppUnits[i] = pUnit;
@@ -1936,31 +1988,38 @@ Unit* Game::GetNewUnit(Faction *fac, int an)
 	}
 	//else add to end
 
+	// grow pointer to pointers to units array
+	if (unitseq >= ppUnits.size())
+		ppUnits.resize(unitseq+10000, nullptr);
+
 	Unit *pUnit = new Unit(unitseq, fac, an);
 	ppUnits[unitseq] = pUnit;
 	++unitseq;
 
-	// grow pointer to pointers to units array
-	if (unitseq >= maxppunits)
-	{
-		Unit **temp = new Unit*[maxppunits+10000];
-		memcpy(temp, ppUnits, maxppunits*sizeof(Unit *));
-		maxppunits += 10000;
-		delete ppUnits;
-		ppUnits = temp;
-	}
-
 	return pUnit;
 }
 
 Unit* Game::GetUnit(int num)
 {
-	if (num < 0 || unsigned(num) >= maxppunits)
+	if (num < 0 || unsigned(num) >= ppUnits.size())
 		return nullptr;
 
 	return ppUnits[num];
 }
 
+bool Game::FindUnit(int num, Location *loc)
+{
+	// units keep their object current (MoveUnit), and objects their region
+	Unit *u = GetUnit(num);
+	if (!u || !u->object)
+		return false; // no such unit, not placed yet, or dead
+
+	loc->unit = u;
+	loc->obj = u->object;
+	loc->region = u->object->region;
+	return true;
+}
+
 void Game::CountAllMages()
 {
 	// clear counts
@@ -2344,52 +2403,52 @@ void Game::MonsterCheck(ARegion *r, Unit *u)
 	u->Event("Controlled demons break free!");
 }
 
-void Game::CheckUnitMaintenance(int consume)
+void Game::CheckUnitMaintenance(Upkeep &upkeep, int consume)
 {
-	CheckUnitMaintenanceItem(I_FOOD, Globals->UPKEEP_FOOD_VALUE, consume);
-	CheckUnitMaintenanceItem(I_GRAIN, Globals->UPKEEP_FOOD_VALUE, consume);
-	CheckUnitMaintenanceItem(I_LIVESTOCK, Globals->UPKEEP_FOOD_VALUE, consume);
-	CheckUnitMaintenanceItem(I_FISH, Globals->UPKEEP_FOOD_VALUE, consume);
+	CheckUnitMaintenanceItem(upkeep, I_FOOD, Globals->UPKEEP_FOOD_VALUE, consume);
+	CheckUnitMaintenanceItem(upkeep, I_GRAIN, Globals->UPKEEP_FOOD_VALUE, consume);
+	CheckUnitMaintenanceItem(upkeep, I_LIVESTOCK, Globals->UPKEEP_FOOD_VALUE, consume);
+	CheckUnitMaintenanceItem(upkeep, I_FISH, Globals->UPKEEP_FOOD_VALUE, consume);
 }
 
-void Game::CheckFactionMaintenance(int con)
+void Game::CheckFactionMaintenance(Upkeep &upkeep, int con)
 {
-	CheckFactionMaintenanceItem(I_FOOD, Globals->UPKEEP_FOOD_VALUE, con);
-	CheckFactionMaintenanceItem(I_GRAIN, Globals->UPKEEP_FOOD_VALUE, con);
-	CheckFactionMaintenanceItem(I_LIVESTOCK, Globals->UPKEEP_FOOD_VALUE, con);
-	CheckFactionMaintenanceItem(I_FISH, Globals->UPKEEP_FOOD_VALUE, con);
+	CheckFactionMaintenanceItem(upkeep, I_FOOD, Globals->UPKEEP_FOOD_VALUE, con);
+	CheckFactionMaintenanceItem(upkeep, I_GRAIN, Globals->UPKEEP_FOOD_VALUE, con);
+	CheckFactionMaintenanceItem(upkeep, I_LIVESTOCK, Globals->UPKEEP_FOOD_VALUE, con);
+	CheckFactionMaintenanceItem(upkeep, I_FISH, Globals->UPKEEP_FOOD_VALUE, con);
 }
 
-void Game::CheckAllyMaintenance()
+void Game::CheckAllyMaintenance(Upkeep &upkeep)
 {
-	CheckAllyMaintenanceItem(I_FOOD, Globals->UPKEEP_FOOD_VALUE);
-	CheckAllyMaintenanceItem(I_GRAIN, Globals->UPKEEP_FOOD_VALUE);
-	CheckAllyMaintenanceItem(I_LIVESTOCK, Globals->UPKEEP_FOOD_VALUE);
-	CheckAllyMaintenanceItem(I_FISH, Globals->UPKEEP_FOOD_VALUE);
+	CheckAllyMaintenanceItem(upkeep, I_FOOD, Globals->UPKEEP_FOOD_VALUE);
+	CheckAllyMaintenanceItem(upkeep, I_GRAIN, Globals->UPKEEP_FOOD_VALUE);
+	CheckAllyMaintenanceItem(upkeep, I_LIVESTOCK, Globals->UPKEEP_FOOD_VALUE);
+	CheckAllyMaintenanceItem(upkeep, I_FISH, Globals->UPKEEP_FOOD_VALUE);
 }
 
-void Game::CheckUnitHunger()
+void Game::CheckUnitHunger(Upkeep &upkeep)
 {
-	CheckUnitHungerItem(I_FOOD, Globals->UPKEEP_FOOD_VALUE);
-	CheckUnitHungerItem(I_GRAIN, Globals->UPKEEP_FOOD_VALUE);
-	CheckUnitHungerItem(I_LIVESTOCK, Globals->UPKEEP_FOOD_VALUE);
-	CheckUnitHungerItem(I_FISH, Globals->UPKEEP_FOOD_VALUE);
+	CheckUnitHungerItem(upkeep, I_FOOD, Globals->UPKEEP_FOOD_VALUE);
+	CheckUnitHungerItem(upkeep, I_GRAIN, Globals->UPKEEP_FOOD_VALUE);
+	CheckUnitHungerItem(upkeep, I_LIVESTOCK, Globals->UPKEEP_FOOD_VALUE);
+	CheckUnitHungerItem(upkeep, I_FISH, Globals->UPKEEP_FOOD_VALUE);
 }
 
-void Game::CheckFactionHunger()
+void Game::CheckFactionHunger(Upkeep &upkeep)
 {
-	CheckFactionHungerItem(I_FOOD, Globals->UPKEEP_FOOD_VALUE);
-	CheckFactionHungerItem(I_GRAIN, Globals->UPKEEP_FOOD_VALUE);
-	CheckFactionHungerItem(I_LIVESTOCK, Globals->UPKEEP_FOOD_VALUE);
-	CheckFactionHungerItem(I_FISH, Globals->UPKEEP_FOOD_VALUE);
+	CheckFactionHungerItem(upkeep, I_FOOD, Globals->UPKEEP_FOOD_VALUE);
+	CheckFactionHungerItem(upkeep, I_GRAIN, Globals->UPKEEP_FOOD_VALUE);
+	CheckFactionHungerItem(upkeep, I_LIVESTOCK, Globals->UPKEEP_FOOD_VALUE);
+	CheckFactionHungerItem(upkeep, I_FISH, Globals->UPKEEP_FOOD_VALUE);
 }
 
-void Game::CheckAllyHunger()
+void Game::CheckAllyHunger(Upkeep &upkeep)
 {
-	CheckAllyHungerItem(I_FOOD, Globals->UPKEEP_FOOD_VALUE);
-	CheckAllyHungerItem(I_GRAIN, Globals->UPKEEP_FOOD_VALUE);
-	CheckAllyHungerItem(I_LIVESTOCK, Globals->UPKEEP_FOOD_VALUE);
-	CheckAllyHungerItem(I_FISH, Globals->UPKEEP_FOOD_VALUE);
+	CheckAllyHungerItem(upkeep, I_FOOD, Globals->UPKEEP_FOOD_VALUE);
+	CheckAllyHungerItem(upkeep, I_GRAIN, Globals->UPKEEP_FOOD_VALUE);
+	CheckAllyHungerItem(upkeep, I_LIVESTOCK, Globals->UPKEEP_FOOD_VALUE);
+	CheckAllyHungerItem(upkeep, I_FISH, Globals->UPKEEP_FOOD_VALUE);
 }
 
 char Game::GetRChar(ARegion *r)
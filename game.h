@@ -25,18 +25,39 @@
 //
 // END A3HEADER
 #include "aregion.h"
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
 
 #define CURRENT_ATL_VER MAKE_ATL_VER( 4, 2, 96 )
 
 class Aorders;
+class Battle;
 class ExchangeOrder;
 class Faction;
 class GiveOrder;
 class Order;
 class OrdersCheck;
 class ProduceOrder;
+class RandomStream;
+class Upkeep;
 class WithdrawOrder;
 
+/// Parts of the turn which roll on random number streams of their own under
+/// the RANDOM_STREAMS rule (the values key the streams, so never renumber)
+enum RandomStreamKey
+{
+	RS_ATTACK_ORDERS,
+	RS_AUTO_ATTACKS,
+	RS_BATTLE,
+	RS_REGION_TURN,
+	RS_WANDERING_MONSTERS,
+	RS_LAIR_MONSTERS
+};
+
 /// All the state for running the game
 class Game
 {
@@ -51,6 +72,13 @@ public:
 	void ModifyTablesPerRuleset(); // enable/disable parts of the data tables
 	void resolveBackRefs();
 
+	/// write faction reports on 'n' threads (1 writes them in order on this thread)
+	void setReportThreads(int n) { reportThreads = n > 1 ? n : 1; }
+	/// fight battles on 'n' threads, if the rules allow (PARALLEL_BATTLES)
+	void setBattleThreads(int n) { battleThreads = n > 1 ? n : 1; }
+	/// save game.out in the binary format if 'binary', else as text, whatever game.in was
+	void setBinarySave(bool binary) { binarySave = binary; saveFormatSet = true; }
+
 	int NewGame(int seed);
 	int OpenGame();
 	int RunGame();
@@ -62,6 +90,15 @@ public:
 	int ViewMap(const AString &, const AString &);
 	void UnitFactionMap();
 	int GenRules(const AString &, const AString &, const AString &);
+	/// fight the battle in 'battlefile' 'runs' times (seeds from 'seed') and
+	/// report throughput and outcomes, optionally checking them against the
+	/// other battle engine (see battlesim.cpp)
+	int SimulateBattles(const AString &battlefile, int runs, int seed,
+	      bool compare = false);
+	/// time benchmark 'name' on 'count' pieces of work, or on its default
+	/// number if 'count' is 0 (see benchmark.cpp)
+	///@return 0 if there is no such benchmark
+	int RunBenchmark(const AString &name, int count);
 	void ViewFactions(); // not used
 
 	///@return faction with id 'n'
@@ -74,6 +111,9 @@ public:
 	// Get a unit by its number
 	Unit* GetUnit(int num);
 
+	///@return true if unit 'num' is in the world, filling 'loc' with its unit, object and region
+	bool FindUnit(int num, Location *loc);
+
 	int currentMonth() const { return month; }
 	int currentYear() const { return year; }
 	int TurnNumber();
@@ -118,6 +158,8 @@ private: // methods
 
 	// get a new unit, with its number assigned
 	Unit* GetNewUnit(Faction *fac, int an = 0);
+	/// time 'count' calls of GetNewUnit (see benchmark.cpp)
+	void BenchmarkNewUnits(int count);
 
 	void PreProcessTurn();
 	void ReadOrders();
@@ -271,23 +313,23 @@ private: // methods
 	int DoWithdrawOrder(ARegion *, Unit *, WithdrawOrder *);
 
 	// These are game specific, and can be found in extra.cpp
-	void CheckUnitMaintenance(int consume);
-	void CheckFactionMaintenance(int consume);
-	void CheckAllyMaintenance();
+	void CheckUnitMaintenance(Upkeep&, int consume);
+	void CheckFactionMaintenance(Upkeep&, int consume);
+	void CheckAllyMaintenance(Upkeep&);
 
 	// Similar to the above, but for minimum food requirements
-	void CheckUnitHunger();
-	void CheckFactionHunger();
-	void CheckAllyHunger();
+	void CheckUnitHunger(Upkeep&);
+	void CheckFactionHunger(Upkeep&);
+	void CheckAllyHunger(Upkeep&);
 
-	void CheckUnitMaintenanceItem(int item, int value, int consume);
-	void CheckFactionMaintenanceItem(int item, int value, int consume);
-	void CheckAllyMaintenanceItem(int item, int value);
+	void CheckUnitMaintenanceItem(Upkeep&, int item, int value, int consume);
+	void CheckFactionMaintenanceItem(Upkeep&, int item, int value, int consume);
+	void CheckAllyMaintenanceItem(Upkeep&, int item, int value);
 
 	// Hunger again
-	void CheckUnitHungerItem(int item, int value);
-	void CheckFactionHungerItem(int item, int value);
-	void CheckAllyHungerItem(int item, int value);
+	void CheckUnitHungerItem(Upkeep&, int item, int value);
+	void CheckFactionHungerItem(Upkeep&, int item, int value);
+	void CheckAllyHungerItem(Upkeep&, int item, int value);
 
 	void AssessMaintenance();
 
@@ -313,12 +355,17 @@ private: // methods
 	void EndGame(Faction *pVictor);
 
 	void RunBuyOrders();
-	void DoBuy(ARegion *,Market *);
-	int GetBuyAmount(ARegion *,Market *);
+	void DoBuy(ARegion *,Market *,MarketOrders &);
+	int GetBuyAmount(ARegion *,Market *,MarketOrders &);
 	void RunSellOrders();
-	void DoSell(ARegion *,Market *);
-	int GetSellAmount(ARegion *,Market *);
+	void DoSell(ARegion *,Market *,MarketOrders &);
+	int GetSellAmount(ARegion *,Market *,MarketOrders &);
 	void DoAttackOrders();
+	void DoAttackOrdersRegion(ARegion *);
+	void RunRegionGroups(int key, void (Game::*work)(ARegion *));
+	/// the random number stream for 'key' under the RANDOM_STREAMS rule,
+	/// or nullptr (keep using the game's stream)
+	std::unique_ptr<RandomStream> TakeStream(std::initializer_list<unsigned> key);
 	void CheckWMonAttack(ARegion *,Unit *);
 	Unit *GetWMonTar(ARegion *,int,Unit *);
 	int CountWMonTars(ARegion *,Unit *);
@@ -390,20 +437,24 @@ private: // methods
 	// Battle function
 	void KillDead(Location *);
 	int RunBattle(ARegion *,Unit *,Unit *,int = 0,int = 0);
+	///@return one line of the battle profile for 'b'
+	std::string ProfileLine(const Battle &b, ARegion *r, Unit *attacker,
+	      Unit *target, int ass, int result);
+	/// write this turn's battle profile (BATTLE_PROFILE)
+	void WriteBattleProfile();
 	void GetSides(ARegion *,AList &,AList &,AList &,AList &,Unit *,Unit *,
 	     int = 0,int = 0);
-	int CanAttack(ARegion *,AList *,Unit *);
 	void GetAFacs(ARegion *,Unit *,Unit *,AList &,AList &,AList &);
 	void GetDFacs(ARegion *,Unit *,AList &);
 
 private: // data
 	AList factions;
-	AList battles;
 	ARegionList regions;
 	int factionseq = 1;
 	unsigned unitseq = 1;
-	Unit **ppUnits = nullptr;
-	unsigned maxppunits = 0;
+	std::vector<Unit*> ppUnits; ///< units by number
+	/// unused unit numbers below unitseq, smallest first
+	std::priority_queue<unsigned, std::vector<unsigned>, std::greater<unsigned>> unitHoles;
 	int shipseq = 100;
 	int year = 1;
 	int month = -1;
@@ -420,6 +471,12 @@ private: // data
 	int guardfaction = 0;
 	int monfaction = 0;
 	int doExtraInit = 0;
+	bool binarySave = false; ///< save game.out in the binary format
+	bool saveFormatSet = false; ///< binarySave was chosen, rather than taken from game.in
+	int reportThreads = 1;
+	int battleThreads = 1;
+	unsigned randomSeed = 0; ///< this turn's seed, from the game file
+	std::vector<std::string> battleProfile; ///< lines for WriteBattleProfile
 };
 
 #endif
@@ -445,6 +445,38 @@ public:
 
     /// Disable command FIND to allow players to be anonymous, communication is handled elsewhere, etc
     int DISABLE_FIND_EMAIL_COMMAND;
+
+	/// Fight battles without specials, spells or mount specials by counting
+	/// soldiers with identical stats together. Odds are unchanged, but the
+	/// random numbers are drawn differently, so results differ in detail
+	/// (the battle simulator can check that they agree overall)
+	int COHORT_BATTLES;
+
+	/// Fight the battles of regions that share no neighbours at the same
+	/// time, each region with its own random numbers (see
+	/// Game::RunRegionGroups).  Results don't depend on the number of battle
+	/// threads, but do differ from the serial order
+	int PARALLEL_BATTLES;
+
+	/// Give battles, regions' end of turn growth and monster growth random
+	/// number streams of their own, derived from the turn's seed, so that
+	/// changing one part of the turn doesn't change the dice everywhere
+	/// else.  Off replays turns exactly as before
+	int RANDOM_STREAMS;
+
+	/// Aim and roll large special attacks a block at a time.  Odds are
+	/// unchanged, but the random numbers are drawn in a different order,
+	/// so results differ in detail
+	int BATCHED_ATTACKS;
+
+	/// Count and time the parts of every battle, and write them to the
+	/// tab separated file battles.<turn number>, one line per battle
+	int BATTLE_PROFILE;
+
+	/// Work out every unit's cached stats (men, weight, capacities,
+	/// tactics, observation, stealth) afresh each time they are asked for,
+	/// and stop with a message if the cached value differs.  For debugging
+	int CHECK_UNIT_STATS;
 };
 
 extern GameDefs *Globals;
@@ -32,6 +32,7 @@ extern "C" {
 }
 
 static randctx isaac_ctx;
+static thread_local randctx *current_ctx = &isaac_ctx; ///< getrandom's stream
 
 char buf[256];
 
@@ -60,7 +61,7 @@ void doneIO()
 {
 }
 
-int getrandom(int range)
+static int draw(randctx *ctx, int range)
 {
 	if (!range)
 		return 0;
@@ -69,7 +70,7 @@ int getrandom(int range)
 	if (neg)
 		range = -range;
 
-	unsigned long i = isaac_rand( &isaac_ctx );
+	unsigned long i = isaac_rand( ctx );
 	i %= range;
 
 	int ret = 0;
@@ -81,15 +82,25 @@ int getrandom(int range)
 	return ret;
 }
 
-void seedrandom(int num)
+int getrandom(int range)
+{
+	return draw( current_ctx, range );
+}
+
+static void seedctx(randctx *ctx, ub4 num)
 {
-	isaac_ctx.randa = isaac_ctx.randb = isaac_ctx.randc = (ub4)0;
+	ctx->randa = ctx->randb = ctx->randc = (ub4)0;
 
 	for (ub4 i = 0; i < RANDSIZ; ++i)
 	{
-		isaac_ctx.randrsl[i] = (ub4)num + i;
+		ctx->randrsl[i] = num + i;
 	}
-	randinit( &isaac_ctx, TRUE );
+	randinit( ctx, TRUE );
+}
+
+void seedrandom(int num)
+{
+	seedctx( &isaac_ctx, (ub4)num );
 }
 
 void seedrandomrandom()
@@ -97,6 +108,52 @@ void seedrandomrandom()
 	seedrandom( time(0) );
 }
 
+RandomStream::RandomStream(unsigned seed)
+: ctx_(new randctx)
+{
+	seedctx(ctx_, seed);
+}
+
+RandomStream::RandomStream(unsigned seed, std::initializer_list<unsigned> key)
+: ctx_(new randctx)
+{
+	// mix each part of the key into the seed, so that nearby keys give
+	// unrelated streams
+	unsigned h = seed;
+	for (unsigned k : key)
+	{
+		h ^= k + 0x9e3779b9 + (h << 6) + (h >> 2);
+		h ^= h >> 16;
+		h *= 0x85ebca6b;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35;
+		h ^= h >> 16;
+	}
+	seedctx(ctx_, h);
+}
+
+RandomStream::~RandomStream()
+{
+	delete ctx_;
+}
+
+int RandomStream::get(int range)
+{
+	return draw( ctx_, range );
+}
+
+RandomStream::Use::Use(RandomStream *stream)
+: prev_(current_ctx)
+{
+	if (stream)
+		current_ctx = stream->ctx_;
+}
+
+RandomStream::Use::~Use()
+{
+	current_ctx = prev_;
+}
+
 int Agetint()
 {
 	int x;
@@ -24,7 +24,9 @@
 // http://www.prankster.com/project
 //
 // END A3HEADER
+#include <initializer_list>
 class AString;
+struct randctx;
 
 /// initialize system resources
 void initIO();
@@ -38,6 +40,41 @@ int getrandom(int r);
 void seedrandom(int);
 void seedrandomrandom();
 
+/// A random number stream of its own, so a part of the game can roll dice
+/// without changing, or depending on, everyone else's rolls
+class RandomStream
+{
+public:
+	explicit RandomStream(unsigned seed);
+	/// the stream for 'key' (a phase, region, battle...) under game seed 'seed'
+	RandomStream(unsigned seed, std::initializer_list<unsigned> key);
+	~RandomStream();
+
+	RandomStream(const RandomStream&) = delete;
+	RandomStream& operator=(const RandomStream&) = delete;
+
+	///@return a random number from 0 to (r-1), from this stream
+	int get(int r);
+
+	/// While a Use exists, getrandom() on its thread draws from its stream
+	/// (a null stream leaves getrandom() as it was)
+	class Use
+	{
+	public:
+		explicit Use(RandomStream *stream);
+		~Use();
+
+		Use(const Use&) = delete;
+		Use& operator=(const Use&) = delete;
+
+	private:
+		randctx *prev_; ///< stream in use before this one
+	};
+
+private:
+	randctx *ctx_;
+};
+
 ///@return an int from the user
 int Agetint();
 
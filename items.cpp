@@ -28,6 +28,7 @@
 #include "gamedata.h"
 #include "fileio.h"
 #include "astring.h"
+#include "keywordindex.h"
 #include <algorithm>
 
 Materials::Materials(const char *iabbr, int a)
@@ -65,62 +66,56 @@ static AString DefType(int atype)
 	return atype == NUM_ATTACK_TYPES ? "all" : AttType(atype);
 }
 
-int ParseAllItems(const AString &token)
+///@return the items named by 'token', in table order
+static const std::vector<int>* FindItems(const AString &token)
 {
-	//foreach item definition
-	for (unsigned i = 0; i < ItemDefs.size(); ++i)
-	{
-		// if the current item is an illusionary version of a monster
-		if ((ItemDefs[i].type & IT_MONSTER) &&
-		     ItemDefs[i].index == MONSTER_ILLUSION)
-		{
-			if (token == (AString("i") + ItemDefs[i].name) ||
-			    token == (AString("i") + ItemDefs[i].names) ||
-			    token == (AString("i") + ItemDefs[i].abr))
+	// names never change, so the index can be built once
+	static const AKeywordIndex items = [] {
+		AKeywordIndex idx;
+		for (unsigned i = 0; i < ItemDefs.size(); ++i)
+		{
+			// illusionary monsters are only known with an 'i' prefix
+			if ((ItemDefs[i].type & IT_MONSTER) &&
+			     ItemDefs[i].index == MONSTER_ILLUSION)
 			{
-				return i;
+				if (ItemDefs[i].name)
+					idx.add((AString("i") + ItemDefs[i].name).str(), i);
+				if (ItemDefs[i].names)
+					idx.add((AString("i") + ItemDefs[i].names).str(), i);
+				if (ItemDefs[i].abr)
+					idx.add((AString("i") + ItemDefs[i].abr).str(), i);
+				continue;
 			}
-			continue;
-		}
 
-		// normal check
-		if (token == ItemDefs[i].name ||
-		    token == ItemDefs[i].names ||
-		    token == ItemDefs[i].abr)
-		{
-			return i;
+			idx.add(ItemDefs[i].name, i);
+			idx.add(ItemDefs[i].names, i);
+			idx.add(ItemDefs[i].abr, i);
 		}
-	}
+		return idx;
+	}();
 
-	return -1;
+	return items.find(token);
 }
 
-int ParseEnabledItem(const AString &token)
+int ParseAllItems(const AString &token)
 {
-	for (unsigned i = 0; i < ItemDefs.size(); ++i)
-	{
-		if (ItemDefs[i].flags & ItemType::DISABLED)
-			continue;
+	const std::vector<int> *found = FindItems(token);
+	if (!found)
+		return -1;
 
-		// if the current item is an illusionary version of a monster
-		if ((ItemDefs[i].type & IT_MONSTER) &&
-		     ItemDefs[i].index == MONSTER_ILLUSION)
-		{
-			if (token == (AString("i") + ItemDefs[i].name) ||
-			    token == (AString("i") + ItemDefs[i].names) ||
-			    token == (AString("i") + ItemDefs[i].abr))
-			{
-				return i;
-			}
-			continue;
-		}
+	return found->front();
+}
 
-		if (token == ItemDefs[i].name ||
-		    token == ItemDefs[i].names ||
-		    token == ItemDefs[i].abr)
-		{
+int ParseEnabledItem(const AString &token)
+{
+	const std::vector<int> *found = FindItems(token);
+	if (!found)
+		return -1;
+
+	for (int i : *found)
+	{
+		if (!(ItemDefs[i].flags & ItemType::DISABLED))
 			return i;
-		}
 	}
 
 	return -1;
@@ -128,36 +123,19 @@ int ParseEnabledItem(const AString &token)
 
 int ParseGiveableItem(AString *token)
 {
-	int r = -1;
-	for (unsigned i = 0; i < ItemDefs.size(); ++i)
-	{
-		if (ItemDefs[i].flags & ItemType::DISABLED)
-			continue;
+	const std::vector<int> *found = FindItems(*token);
+	if (!found)
+		return -1;
 
-		if (ItemDefs[i].flags & ItemType::CANTGIVE)
-			continue;
-
-		if ((ItemDefs[i].type & IT_MONSTER) &&
-		     ItemDefs[i].index == MONSTER_ILLUSION)
-		{
-			if (*token == (AString("i") + ItemDefs[i].name) ||
-			    *token == (AString("i") + ItemDefs[i].names) ||
-			    *token == (AString("i") + ItemDefs[i].abr))
-			{
-				return i;
-			}
+	for (int i : *found)
+	{
+		if (ItemDefs[i].flags & (ItemType::DISABLED | ItemType::CANTGIVE))
 			continue;
-		}
 
-		if (*token == ItemDefs[i].name ||
-		    *token == ItemDefs[i].names ||
-		    *token == ItemDefs[i].abr)
-		{
-			return i;
-		}
+		return i;
 	}
 
-	return r;
+	return -1;
 }
 
 int ParseBattleItem(int item)
@@ -582,6 +560,57 @@ void Item::Readin(Ainfile *f)
 }
 
 //----------------------------------------------------------------------------
+///@return index of the first of the 'n' items in 'a' (sorted by type)
+/// which is not before 'type'
+static unsigned FirstOf(Item *const *a, unsigned n, int type)
+{
+	unsigned first = 0;
+	while (n)
+	{
+		const unsigned half = n / 2;
+		if (a[first + half]->type < type)
+		{
+			first += half + 1;
+			n -= half + 1;
+		}
+		else
+		{
+			n = half;
+		}
+	}
+	return first;
+}
+
+Item* ItemList::find(int t) const
+{
+	const unsigned i = FirstOf(index_.data(), index_.size(), t);
+	return (i < index_.size() && index_[i]->type == t) ? index_[i] : nullptr;
+}
+
+void ItemList::add(Item *item)
+{
+	++version_;
+	Add(item);
+	const unsigned i = FirstOf(index_.data(), index_.size(), item->type);
+	index_.insert(index_.begin() + i, item);
+}
+
+void ItemList::erase(Item *item)
+{
+	++version_;
+	const unsigned i = FirstOf(index_.data(), index_.size(), item->type);
+	index_.erase(index_.begin() + i);
+	Remove(item);
+	delete item;
+}
+
+void ItemList::deleteAll()
+{
+	++version_;
+	index_.clear();
+	AList::deleteAll();
+}
+
 void ItemList::Writeout(Aoutfile *f)
 {
 	f->PutInt(Num());
@@ -600,22 +629,24 @@ void ItemList::Readin(Ainfile *f)
 		{
 			delete temp;
 		}
+		else if (Item *had = find(temp->type))
+		{
+			// (listed twice) keep one item of each type
+			had->num += temp->num;
+			++version_;
+			delete temp;
+		}
 		else
 		{
-			Add(temp);
+			add(temp);
 		}
 	}
 }
 
 int ItemList::GetNum(int t)
 {
-	forlist(this)
-	{
-		Item *i = (Item*)elem;
-		if (i->type == t)
-			return i->num;
-	}
-	return 0;
+	const Item *i = find(t);
+	return i ? i->num : 0;
 }
 
 int ItemList::Weight()
@@ -631,23 +662,14 @@ int ItemList::Weight()
 
 int ItemList::CanSell(int t)
 {
-	forlist(this)
-	{
-		Item *i = (Item*)elem;
-		if (i->type == t)
-			return i->num - i->selling;
-	}
-	return 0;
+	const Item *i = find(t);
+	return i ? i->num - i->selling : 0;
 }
 
 void ItemList::Selling(int t, int n)
 {
-	forlist(this)
-	{
-		Item *i = (Item*)elem;
-		if (i->type == t)
-			i->selling += n;
-	}
+	if (Item *i = find(t))
+		i->selling += n;
 }
 
 AString ItemList::Report(const int obs, const int seeillusions, int nofirstcomma)
@@ -699,34 +721,24 @@ AString ItemList::BattleReport()
 
 void ItemList::SetNum(int t, int n)
 {
+	Item *i = find(t);
+
 	// if item is going away
 	if (n == 0)
 	{
-		forlist(this)
-		{
-			Item *i = (Item*)elem;
-			if (i->type == t)
-			{
-				Remove(i);
-				delete i;
-				return;
-			}
-		}
+		if (i)
+			erase(i);
 		return;
 	}
 
 	// check existing items for match
-	forlist(this)
+	if (i)
 	{
-		Item *i = (Item*)elem;
-		if (i->type == t)
-		{
-			// found it
-			i->num = n;
-			return;
-		}
+		i->num = n;
+		++version_;
+		return;
 	}
 
 	//else add an item
-	Add(new Item(t, n));
+	add(new Item(t, n));
 }
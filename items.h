@@ -25,6 +25,7 @@
 //
 // END A3HEADER
 #include "alist.h"
+#include <vector>
 class Ainfile;
 class Aoutfile;
 class AString;
@@ -448,6 +449,37 @@ public:
 
 	/// mark 'num' items of 'type' as going to sell
 	void Selling(int type, int num);
+
+	/// delete all items
+	void DeleteAll() { deleteAll(); }
+	void deleteAll();
+
+	///@return a count which moves on whenever the items change
+	unsigned Version() const { return version_; }
+
+private:
+	///@return the item of 'type', or NULL
+	Item* find(int type) const;
+
+	/// put 'item' at the end of the list
+	void add(Item *item);
+
+	/// take 'item' out of the list and delete it
+	void erase(Item *item);
+
+	// the list only changes through add() and erase(), which keep the index
+	using AList::Add;
+	using AList::push_back;
+	using AList::Insert;
+	using AList::push_front;
+	using AList::Remove;
+	using AList::remove;
+	using AList::Empty;
+	using AList::clear;
+
+private:
+	std::vector<Item*> index_; ///< the items sorted by type, for lookups
+	unsigned version_ = 0;     ///< see Version()
 };
 
 AString ShowSpecial(int special, int level, int expandLevel, int fromItem);
@@ -0,0 +1,58 @@
+// START A3HEADER
+//
+// This source file is part of the Atlantis PBM game program.
+// Copyright (C) 1995-1999 Geoff Dunbar
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program, in the file license.txt. If not, write
+// to the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+// Boston, MA 02111-1307, USA.
+//
+// See the Atlantis Project web page for details:
+// http://www.prankster.com/project
+//
+// END A3HEADER
+#include "keywordindex.h"
+#include "astring.h"
+
+std::string AKeywordIndex::fold(const char *s)
+{
+	std::string ret(s);
+	for (auto &c : ret)
+	{
+		if (c >= 'A' && c <= 'Z')
+			c = c - 'A' + 'a';
+		else if (c == '_')
+			c = ' ';
+	}
+	return ret;
+}
+
+void AKeywordIndex::add(const char *name, int index)
+{
+	if (!name)
+		return;
+
+	std::vector<int> &v = index_[fold(name)];
+	if (v.empty() || v.back() != index)
+		v.push_back(index);
+}
+
+const std::vector<int>* AKeywordIndex::find(const AString &key) const
+{
+	auto i = index_.find(fold(key.str()));
+	if (i == index_.end())
+		return nullptr;
+
+	return &i->second;
+}
@@ -0,0 +1,53 @@
+#ifndef KEYWORD_INDEX_CLASS
+#define KEYWORD_INDEX_CLASS
+// START A3HEADER
+//
+// This source file is part of the Atlantis PBM game program.
+// Copyright (C) 1995-1999 Geoff Dunbar
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program, in the file license.txt. If not, write
+// to the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+// Boston, MA 02111-1307, USA.
+//
+// See the Atlantis Project web page for details:
+// http://www.prankster.com/project
+//
+// END A3HEADER
+#include <string>
+#include <unordered_map>
+#include <vector>
+class AString;
+
+/**
+ * Lookup from names to table indices, comparing the way AString::operator==
+ * does (ignoring case, with '_' the same as space).  A name keeps every index
+ * it was added for, in order, so callers can skip entries and take the next.
+ */
+class AKeywordIndex
+{
+public:
+	/// add 'name' (ignored if NULL) for 'index'
+	void add(const char *name, int index);
+
+	///@return indices for 'key' in the order added, or NULL if none
+	const std::vector<int>* find(const AString &key) const;
+
+private:
+	///@return 's' folded to the form used for comparison
+	static std::string fold(const char *s);
+
+private:
+	std::unordered_map<std::string, std::vector<int>> index_;
+};
+#endif
@@ -32,20 +32,22 @@
 #include "astring.h"
 #include "fileio.h"
 #include <map>
+#include <stdlib.h>
 
 namespace
 {
 void usage()
 {
-	Awrite("atlantis new");
-	Awrite("atlantis run");
-	Awrite("atlantis edit");
+	Awrite("atlantis new [--binary]");
+	Awrite("atlantis run [--binary | --text] [<report threads> [<battle threads>]]");
+	Awrite("atlantis edit [--binary | --text]");
 	Awrite("");
 	Awrite("atlantis map <type> <mapfile>");
 	Awrite("atlantis mapunits");
 	Awrite("atlantis genrules <introfile> <cssfile> <rules-outputfile>");
 	Awrite("");
 	Awrite("atlantis check <orderfile> <checkfile>");
+	Awrite("atlantis convert <gamefile> <outfile>");
 	Awrite("atlantis dump <outfile>");
 }
 
@@ -91,6 +93,11 @@ void doMap(Game &game, int argc, const char *argv[])
 
 void doRun(Game &game, int argc, const char *argv[])
 {
+	if (argc > 2)
+		game.setReportThreads(AString(argv[2]).value());
+	if (argc > 3)
+		game.setBattleThreads(AString(argv[3]).value());
+
 	if (!game.OpenGame()) {
 		Awrite("Couldn't open the game file!");
 		return;
@@ -143,6 +150,47 @@ void doCheck(Game &game, int argc, const char *argv[])
 	}
 }
 
+/// convert a game file between the text and binary formats (whichever it is not)
+void doConvert(Game &game, int argc, const char *argv[])
+{
+	if (argc != 4) {
+		usage();
+		return;
+	}
+
+	Ainfile in;
+	if (in.OpenByName(argv[2]) == -1) {
+		Awrite("Couldn't open the game file!");
+		return;
+	}
+
+	const bool toBinary = !in.isBinary();
+	Aoutfile out;
+	if (out.OpenByName(argv[3], toBinary) == -1) {
+		Awrite("Couldn't open the output file!");
+		return;
+	}
+
+	// one line per record; lines which print back the same as ints are ints
+	int records = 0;
+	for (AString *line = in.GetStrNoSkip(); line; line = in.GetStrNoSkip())
+	{
+		const char *s = line->str();
+		char *end = nullptr;
+		const long v = strtol(s, &end, 10);
+
+		if (toBinary && *s && !*end && v == int(v) && AString(int(v)) == *line)
+			out.PutInt(int(v));
+		else
+			out.PutStr(*line);
+
+		delete line;
+		++records;
+	}
+
+	Awrite(AString("Converted ") + records + (toBinary ? " lines to binary" : " records to text"));
+}
+
 void doMapUnits(Game &game, int argc, const char *argv[])
 {
 	if (!game.OpenGame()) {
@@ -730,6 +778,19 @@ int main(int argc, const char *argv[])
 			ATL_VER_STRING(Globals->RULESET_VERSION));
 	Awrite("");
 
+	// --binary and --text choose the format game.out is saved in; without
+	// them a new game is saved as text and an old one as game.in was
+	int args = 1;
+	for (int i = 1; i < argc; i++) {
+		if (AString(argv[i]) == "--binary")
+			game.setBinarySave(true);
+		else if (AString(argv[i]) == "--text")
+			game.setBinarySave(false);
+		else
+			argv[args++] = argv[i];
+	}
+	argc = args;
+
 	if (argc == 1) {
 		usage();
 		doneIO();
@@ -743,6 +804,7 @@ int main(int argc, const char *argv[])
 
 	const std::map<std::string, Handler*> cmds = {
 		{"check", doCheck},
+		{"convert", doConvert},
 		{"dump", doDumpData},
 		{"edit", doEdit},
 		{"genrules", doGenRules},
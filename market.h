@@ -25,9 +25,13 @@
 //
 // END A3HEADER
 #include "alist.h"
+#include <unordered_map>
+#include <vector>
 class Ainfile;
 class Aoutfile;
 class AString;
+class Order;
+class Unit;
 
 /// Types of market listings
 enum
@@ -72,4 +76,33 @@ public:
 	void Readin(Ainfile *f);
 };
 
+/// The BUY or SELL orders of a region grouped by item, so that each market
+/// goes through only the orders for its own item
+class MarketOrders
+{
+public:
+	/// an order and the unit which gave it
+	struct Entry
+	{
+		Unit *unit;
+		Order *order;
+	};
+
+	/// add the next order for 'item' (in region order)
+	void Add(int item, Unit *u, Order *o) { orders_[item].push_back({u, o}); }
+
+	///@return the orders for 'item', in the order the units gave them
+	std::vector<Entry>& Get(int item)
+	{
+		if (orders_.empty())
+			return none_;
+		auto i = orders_.find(item);
+		return (i == orders_.end()) ? none_ : i->second;
+	}
+
+private:
+	std::unordered_map<int, std::vector<Entry>> orders_;
+	std::vector<Entry> none_; ///< (always empty)
+};
+
 #endif
@@ -202,6 +202,12 @@ static GameDefs g = {
 	1,	// PREVENT_SAIL_THROUGH
 	0,	// ALLOW_TRIVIAL_PORTAGE
 	1,  // DISABLE_FIND_EMAIL_COMMAND
+	0,	// COHORT_BATTLES
+	0,	// PARALLEL_BATTLES
+	0,	// RANDOM_STREAMS
+	0,	// BATCHED_ATTACKS
+	0,	// BATTLE_PROFILE
+	0,	// CHECK_UNIT_STATS
 };
 
 GameDefs * Globals = &g;
@@ -29,6 +29,7 @@
 #include "gamedata.h"
 #include "object.h"
 #include "orders.h"
+#include "movequeue.h"
 #include <map>
 
 //----------------------------------------------------------------------------
@@ -702,7 +703,7 @@ void Game::RunBuildHelpers(ARegion *r)
 		Object *obj = (Object*)elem;
 
 		//foreach unit in the object
-		for(auto &u : obj->getUnits())
+		for(auto &u : obj->snapshotUnits())
 		{
 			// if unit is not building
 			if (!u->monthorders || u->monthorders->type != O_BUILD)
@@ -1434,26 +1435,25 @@ void Game::Do1StudyOrder(Unit *u, Object *obj)
 
 void Game::RunMoveOrders()
 {
+	// only regions with units due to move are walked
+	MoveQueue queue(regions, Globals->MAX_SPEED);
+
 	for (int phase = 0; phase < Globals->MAX_SPEED; ++phase)
 	{
 		// before processing region to region moves, process leading OUT/ENTER
+		queue.StartEnters();
+		while (ARegion *region = queue.NextRegion())
 		{
-			//foreach region
-			forlist((&regions))
+			//foreach object
+			forlist((&region->objects))
 			{
-				ARegion *region = (ARegion*)elem;
+				Object *obj = (Object*)elem;
 
-				//foreach object
-				forlist((&region->objects))
+				//foreach unit
+				for(auto &unit : obj->snapshotUnits())
 				{
-					Object *obj = (Object*)elem;
-
-					//foreach unit
-					for(auto &unit : obj->getUnits())
-					{
-						Object *tempobj = obj;
-						DoMoveEnter(unit, region, &tempobj);
-					}
+					Object *tempobj = obj;
+					DoMoveEnter(unit, region, &tempobj);
 				}
 			}
 		}
@@ -1461,18 +1461,16 @@ void Game::RunMoveOrders()
 		// now process actual moves
 		AList *locs = new AList;
 
-		//foreach region
-		forlist((&regions))
+		queue.StartMoves(phase);
+		while (ARegion *region = queue.NextRegion())
 		{
-			ARegion *region = (ARegion*)elem;
-
 			//foreach object
 			forlist((&region->objects))
 			{
 				Object *obj = (Object*)elem;
 
 				//foreach unit
-				const auto units = obj->getUnits();
+				const auto units = obj->snapshotUnits();
 				for(auto &unit : units)
 				{
 					if (phase == unit->movepoints && unit->monthorders &&
@@ -1481,6 +1479,7 @@ void Game::RunMoveOrders()
 					    !unit->nomove)
 					{
 						locs->Add(DoAMoveOrder(unit, region, obj));
+						queue.Moved(unit);
 					}
 				}
 			}
@@ -0,0 +1,144 @@
+// START A3HEADER
+//
+// This source file is part of the Atlantis PBM game program.
+// Copyright (C) 1995-1999 Geoff Dunbar
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program, in the file license.txt. If not, write
+// to the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+// Boston, MA 02111-1307, USA.
+//
+// See the Atlantis Project web page for details:
+// http://www.prankster.com/project
+//
+// END A3HEADER
+#include "movequeue.h"
+#include "aregion.h"
+#include "gamedata.h"
+#include "object.h"
+#include "orders.h"
+#include "unit.h"
+
+///@return true if 'u' has a MOVE or ADVANCE order
+static bool IsMoving(const Unit *u)
+{
+	return u->monthorders &&
+	       (u->monthorders->type == O_MOVE || u->monthorders->type == O_ADVANCE);
+}
+
+///@return true if the next move of 'u' is OUT or ENTER
+static bool IsEntering(const Unit *u)
+{
+	const MoveOrder *o = (const MoveOrder*)u->monthorders;
+	const MoveDir *x = (const MoveDir*)o->dirs.First();
+	return x && (x->dir == MOVE_OUT || x->dir >= MOVE_ENTER);
+}
+
+MoveQueue::MoveQueue(ARegionList &regions, int phases)
+	: phases_(phases)
+{
+	forlist(&regions)
+	{
+		ARegion *r = (ARegion*)elem;
+		position_[r] = order_.size();
+		order_.push_back(r);
+
+		forlist(&r->objects)
+		{
+			Object *obj = (Object*)elem;
+			for (auto &u : obj->getUnits())
+			{
+				if (!IsMoving(u))
+					continue;
+
+				queue(u);
+				entering_.push_back(u);
+			}
+		}
+	}
+}
+
+void MoveQueue::StartEnters()
+{
+	current_ = -1;
+	for (Unit *u : entering_)
+	{
+		// (units killed on the way have left their object)
+		if (u->object && IsMoving(u) && IsEntering(u))
+			addRegion(u);
+	}
+	entering_.clear();
+}
+
+void MoveQueue::StartMoves(int phase)
+{
+	current_ = -1;
+	for (Unit *u : phases_[phase])
+	{
+		if (u->object && u->movepoints == phase && IsMoving(u))
+			addRegion(u);
+	}
+	phases_[phase].clear();
+}
+
+ARegion* MoveQueue::NextRegion()
+{
+	// skip regions handed out already, or passed over
+	while (!pass_.empty() && pass_.top() <= current_)
+		pass_.pop();
+
+	if (pass_.empty())
+		return nullptr;
+
+	current_ = pass_.top();
+	pass_.pop();
+	return order_[current_];
+}
+
+void MoveQueue::Moved(Unit *u)
+{
+	if (!u->object)
+		return;
+
+	// any next OUT/ENTER is run at the start of the next phase
+	entering_.push_back(u);
+
+	// a ship or army carries its units, and their movepoints, along
+	if (ObjectIsShip(u->object->type) || u->object->type == O_ARMY)
+	{
+		for (auto &carried : u->object->getUnits())
+		{
+			if (IsMoving(carried))
+				queue(carried);
+		}
+	}
+	else
+	{
+		queue(u);
+	}
+
+	addRegion(u);
+}
+
+void MoveQueue::addRegion(const Unit *u)
+{
+	const int pos = position_[u->object->region];
+	if (pos > current_)
+		pass_.push(pos);
+}
+
+void MoveQueue::queue(Unit *u)
+{
+	if (u->movepoints < int(phases_.size()))
+		phases_[u->movepoints].push_back(u);
+}
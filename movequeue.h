@@ -0,0 +1,76 @@
+#ifndef MOVE_QUEUE_CLASS
+#define MOVE_QUEUE_CLASS
+// START A3HEADER
+//
+// This source file is part of the Atlantis PBM game program.
+// Copyright (C) 1995-1999 Geoff Dunbar
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program, in the file license.txt. If not, write
+// to the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+// Boston, MA 02111-1307, USA.
+//
+// See the Atlantis Project web page for details:
+// http://www.prankster.com/project
+//
+// END A3HEADER
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+class ARegion;
+class ARegionList;
+class Unit;
+
+//----------------------------------------------------------------------------
+/// Units with MOVE or ADVANCE orders, by the phase in which they next move,
+/// gathered once per turn (see Game::RunMoveOrders).  Each pass of a phase
+/// hands out only the regions where units have something to do, in the
+/// order of the region list, so walking those regions does what walking
+/// every region would
+class MoveQueue
+{
+public:
+	MoveQueue(ARegionList &regions, int phases);
+	MoveQueue(const MoveQueue&) = delete;
+	MoveQueue& operator=(const MoveQueue&) = delete;
+
+	/// start the pass for leading OUT/ENTER moves
+	void StartEnters();
+
+	/// start the pass for region to region moves in 'phase'
+	void StartMoves(int phase);
+
+	///@return the next region of the pass, or NULL when it is over
+	ARegion* NextRegion();
+
+	/// 'u' has made a region to region move in the current pass (carrying
+	/// the units of its ship or army along)
+	void Moved(Unit *u);
+
+private:
+	/// add the region of 'u' to the pass, unless the pass is past it
+	void addRegion(const Unit *u);
+
+	/// put 'u' in the phase of its movepoints
+	void queue(Unit *u);
+
+private:
+	std::vector<ARegion*> order_;                        ///< the region list
+	std::unordered_map<const ARegion*, int> position_; ///< index in order_
+	std::vector<std::vector<Unit*>> phases_;   ///< units by next move phase
+	std::vector<Unit*> entering_;  ///< units which may have OUT/ENTER to do
+	std::priority_queue<int, std::vector<int>, std::greater<int>> pass_;
+	int current_ = -1; ///< position of the region last handed out
+};
+#endif
@@ -620,11 +620,11 @@ AString* ObjectDescription(int obj)
 		buildable = false;
 
 	// if the skill is disabled
-	if (SkillDefs[o->skill].flags & SkillType::DISABLED)
+	else if (SkillDefs[o->skill].flags & SkillType::DISABLED)
 		buildable = false;
 
 	// wood or stone requires two checks and'ed together
-	if (o->item != I_WOOD_OR_STONE &&
+	else if (o->item != I_WOOD_OR_STONE &&
 	    (ItemDefs[o->item].flags & ItemType::DISABLED))
 		buildable = false;
 
@@ -150,7 +150,10 @@ public:
 	void addUnit(Unit *u);
 	void prependUnit(Unit *u);
 	void removeUnit(Unit *u, bool remove_from_sub);
-	std::vector<Unit*> getUnits() { return units; }
+	///@return read-only view of the units inside (do not add or remove units while iterating)
+	const std::vector<Unit*>& getUnits() const { return units; }
+	///@return copy of the units inside, for loops which move units in or out
+	std::vector<Unit*> snapshotUnits() const { return units; }
 
 	Object* findUnitSubObject(Unit *u);
 
@@ -25,6 +25,7 @@
 #include "orders.h"
 #include "unit.h"
 #include "astring.h"
+#include "keywordindex.h"
 
 const char *const od[] =
 {
@@ -96,11 +97,18 @@ const char* const *OrderStrs = od;
 
 int Parse1Order(AString *token)
 {
-	for (int i = 0; i < NORDERS; ++i)
-		if (*token == OrderStrs[i])
-			return i;
+	static const AKeywordIndex orders = [] {
+		AKeywordIndex idx;
+		for (int i = 0; i < NORDERS; ++i)
+			idx.add(OrderStrs[i], i);
+		return idx;
+	}();
 
-	return -1;
+	const std::vector<int> *found = orders.find(*token);
+	if (!found)
+		return -1;
+
+	return found->front();
 }
 
 Order::Order(int o)
@@ -30,7 +30,12 @@
 #include "object.h"
 #include "orders.h"
 #include "gameio.h"
+#include "upkeep.h"
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
 
 //----------------------------------------------------------------------------
 ///@return true if the man type given by 'manIdx' is compatible with faction alignment 'a'
@@ -267,7 +272,7 @@ void Game::RunStealOrders()
 		forlist(&r->objects) {
 			Object * o = (Object *) elem;
 
-			const auto units = o->getUnits(); // make copy
+			const auto units = o->snapshotUnits(); // make copy
 			for (auto &u : units)
 			{
 				if (u->stealorders)
@@ -499,7 +504,7 @@ void Game::DrownUnits()
 			if (o->type != O_DUMMY)
 				continue;
 
-			for(auto &u : o->getUnits())
+			for(auto &u : o->snapshotUnits())
 			{
 				bool drown = false;
 				if (u->type == U_WMON)
@@ -567,7 +572,7 @@ void Game::SinkUncrewedShips()
 			//else no men, move all units out to ocean
 
 			{
-				for (auto &u : o->getUnits())
+				for (auto &u : o->snapshotUnits())
 				{
 					u->MoveUnit(r->GetDummy());
 				}
@@ -630,12 +635,14 @@ void Game::Do1Quit(Faction *f)
 		forlist(&r->objects)
 		{
 			Object *o = (Object*)elem;
-			for (auto &u : o->getUnits())
+			for (auto &u : o->snapshotUnits())
 			{
 				if (u->faction == f)
 				{
+					// park in hell, so the unit number stays valid until EmptyHell
 					o->removeUnit(u, true);
-					delete u;
+					u->object = NULL;
+					r->hell.Add(u);
 				}
 			}
 		}
@@ -653,7 +660,7 @@ void Game::RunDestroyOrders()
 			if (o->type == O_DUMMY || o->type == O_ARMY)
 				continue;
 
-			for (auto &u : o->getUnits())
+			for (auto &u : o->snapshotUnits())
 			{
 				if (u && u->destroy && o->GetOwner() && u->faction == o->GetOwner()->faction)
 					Do1Destroy(r, o, u);
@@ -696,7 +703,7 @@ void Game::Do1Destroy(ARegion *r, Object *o, Unit *u)
 	u->Event(AString("Destroys ") + *(o->name) + ".");
 
 	Object *dest = r->GetDummy();
-	for (auto &u : o->getUnits())
+	for (auto &u : o->snapshotUnits())
 	{
 		u->destroy = 0;
 		u->MoveUnit(dest);
@@ -951,7 +958,7 @@ void Game::RunPromoteOrders()
 			if (o->type == O_DUMMY)
 				continue;
 
-			for (auto &u : o->getUnits())
+			for (auto &u : o->snapshotUnits())
 			{
 				if (u && u->promote && o->GetOwner() && u->faction == o->GetOwner()->faction)
 				{
@@ -974,7 +981,7 @@ void Game::RunPromoteOrders()
 				if (o->type == O_DUMMY)
 					continue;
 
-				for (auto &u : o->getUnits())
+				for (auto &u : o->snapshotUnits())
 				{
 					if (u && u->evictorders && o->GetOwner() && u->faction == o->GetOwner()->faction)
 					{
@@ -1081,7 +1088,7 @@ void Game::RunEnterOrders()
 		forlist(&r->objects)
 		{
 			Object *o = (Object*)elem;
-			for (auto &u : o->getUnits())
+			for (auto &u : o->snapshotUnits())
 			{
 				if (u->enter_)
 				{
@@ -1099,7 +1106,7 @@ void Game::RunEnterOrders()
 		forlist(&r->objects)
 		{
 			Object *o = (Object*)elem;
-			for (auto &u : o->getUnits())
+			for (auto &u : o->snapshotUnits())
 			{
 				if (u->joinorders)
 				{
@@ -1269,7 +1276,6 @@ void Game::Do1JoinOrder(ARegion *r, Object *in, Unit *u)
 			to_obj->addUnit(au);
 			au->object = to_obj;
 		}
-		fm_obj->getUnits().clear();
 
 		delete fm_obj;
 		return;
@@ -1315,7 +1321,7 @@ void Game::RemoveEmptyObjects()
 			if (ObjectDefs[o->type].cost &&
 			    o->incomplete >= ObjectDefs[o->type].cost)
 			{
-				for (auto &u : o->getUnits())
+				for (auto &u : o->snapshotUnits())
 				{
 					u->MoveUnit(r->GetDummy());
 				}
@@ -1370,7 +1376,7 @@ void Game::MidProcessTurn()
 		forlist(&r->objects)
 		{
 			Object *o = (Object*)elem;
-			for (auto &u : o->getUnits())
+			for (auto &u : o->snapshotUnits())
 			{
 				MidProcessUnit(r, u);
 			}
@@ -1383,6 +1389,9 @@ void Game::PostProcessTurn()
 	forlist(&regions)
 	{
 		ARegion *r = (ARegion*)elem;
+		std::unique_ptr<RandomStream> stream(TakeStream({RS_REGION_TURN, unsigned(r->num)}));
+		RandomStream::Use use(stream.get());
+
 		r->PostTurn(&regions);
 
 		if (Globals->CITY_MONSTERS_EXIST && (r->town || r->type == R_NEXUS))
@@ -1391,18 +1400,27 @@ void Game::PostProcessTurn()
 		forlist (&r->objects)
 		{
 			Object *o = (Object*)elem;
-			for (auto &u : o->getUnits())
+			for (auto &u : o->snapshotUnits())
 			{
 				PostProcessUnit(r, u);
 			}
 		}
 	}
 
-	if (Globals->WANDERING_MONSTERS_EXIST) GrowWMons(Globals->WMON_FREQUENCY);
-
-	if (Globals->LAIR_MONSTERS_EXIST) GrowLMons(Globals->LAIR_FREQUENCY);
+	if (Globals->WANDERING_MONSTERS_EXIST)
+	{
+		std::unique_ptr<RandomStream> stream(TakeStream({RS_WANDERING_MONSTERS}));
+		RandomStream::Use use(stream.get());
+		GrowWMons(Globals->WMON_FREQUENCY);
+	}
 
-	if (Globals->LAIR_MONSTERS_EXIST) GrowVMons();
+	if (Globals->LAIR_MONSTERS_EXIST)
+	{
+		std::unique_ptr<RandomStream> stream(TakeStream({RS_LAIR_MONSTERS}));
+		RandomStream::Use use(stream.get());
+		GrowLMons(Globals->LAIR_FREQUENCY);
+		GrowVMons();
+	}
 
 	// Check if there are any factions left
 	bool livingFacs = false;
@@ -1430,6 +1448,12 @@ void Game::PostProcessTurn()
 
 void Game::DoAutoAttacks()
 {
+	if (Globals->PARALLEL_BATTLES)
+	{
+		RunRegionGroups(RS_AUTO_ATTACKS, &Game::DoAutoAttacksRegion);
+		return;
+	}
+
 	forlist(&regions) {
 		ARegion *r = (ARegion*)elem;
 		DoAutoAttacksRegion(r);
@@ -1440,7 +1464,7 @@ void Game::DoAutoAttacksRegion(ARegion *r)
 {
 	forlist(&r->objects) {
 		Object *o = (Object*)elem;
-		for (auto &u : o->getUnits())
+		for (auto &u : o->snapshotUnits())
 		{
 			if (u->IsAlive() && u->canattack)
 				DoAutoAttack(r, u);
@@ -1486,7 +1510,7 @@ void Game::DoAutoAttackOn(ARegion *r, Unit *t)
 	forlist(&r->objects)
 	{
 		Object *o = (Object*)elem;
-		for (auto &u : o->getUnits())
+		for (auto &u : o->snapshotUnits())
 		{
 			if (u->guard != GUARD_AVOID &&
 			    u->GetAttitude(r, t) == A_HOSTILE && u->IsAlive() &&
@@ -1516,7 +1540,7 @@ void Game::DoAutoAttack(ARegion *r, Unit *u)
 	forlist(&r->objects)
 	{
 		Object *o = (Object*)elem;
-		for (auto &t : o->getUnits())
+		for (auto &t : o->snapshotUnits())
 		{
 			if (u->guard != GUARD_AVOID && u->GetAttitude(r, t) == A_HOSTILE)
 			{
@@ -1587,50 +1611,161 @@ void Game::CheckWMonAttack(ARegion *r, Unit *u)
 
 void Game::DoAttackOrders()
 {
+	if (Globals->PARALLEL_BATTLES)
+	{
+		RunRegionGroups(RS_ATTACK_ORDERS, &Game::DoAttackOrdersRegion);
+		return;
+	}
+
 	forlist(&regions)
 	{
 		ARegion *r = (ARegion*)elem;
-		forlist(&r->objects)
+		DoAttackOrdersRegion(r);
+	}
+}
+
+void Game::DoAttackOrdersRegion(ARegion *r)
+{
+	forlist(&r->objects)
+	{
+		Object *o = (Object*)elem;
+		for (auto &u : o->snapshotUnits())
 		{
-			Object *o = (Object*)elem;
-			for (auto &u : o->getUnits())
+			if (u->type == U_WMON)
 			{
-				if (u->type == U_WMON)
+				if (u->canattack && u->IsAlive())
 				{
-					if (u->canattack && u->IsAlive())
-					{
-						CheckWMonAttack(r, u);
-					}
-					continue;
+					CheckWMonAttack(r, u);
 				}
+				continue;
+			}
 
-				if (u->IsAlive() && u->attackorders)
+			if (u->IsAlive() && u->attackorders)
+			{
+				AttackOrder *ord = u->attackorders;
+				while (ord->targets.Num())
 				{
-					AttackOrder *ord = u->attackorders;
-					while (ord->targets.Num())
-					{
-						UnitId *id = (UnitId*)ord->targets.First();
-						ord->targets.Remove(id);
-						Unit *t = r->GetUnitId(id, u->faction->num);
-						delete id;
+					UnitId *id = (UnitId*)ord->targets.First();
+					ord->targets.Remove(id);
+					Unit *t = r->GetUnitId(id, u->faction->num);
+					delete id;
 
-						if (u->canattack && u->IsAlive())
-						{
-							if (t) {
-								AttemptAttack(r, u, t, 0);
-							} else {
-								u->Error("ATTACK: Non-existent unit.");
-							}
+					if (u->canattack && u->IsAlive())
+					{
+						if (t) {
+							AttemptAttack(r, u, t, 0);
+						} else {
+							u->Error("ATTACK: Non-existent unit.");
 						}
 					}
-					delete ord;
-					u->attackorders = nullptr;
 				}
+				delete ord;
+				u->attackorders = nullptr;
 			}
 		}
 	}
 }
 
+/*
+ * Do 'work' for each region with units, for the PARALLEL_BATTLES rule.
+ * A battle draws in units from the neighbouring regions, so regions are
+ * put in groups where no two share a neighbour, and the regions of one
+ * group are worked on battleThreads threads at once.  Each region draws
+ * from its own random number stream (for 'key' and the region number,
+ * under RANDOM_STREAMS), and its faction changes are made
+ * after its group in region order, so the results don't depend on the
+ * number of threads.
+ */
+void Game::RunRegionGroups(int key, void (Game::*work)(ARegion *))
+{
+	// without RANDOM_STREAMS, seed the region streams from the game's stream
+	const unsigned seed = Globals->RANDOM_STREAMS ? 0 : getrandom(0x40000000);
+
+	int maxNum = 0;
+	{
+		forlist(&regions)
+			maxNum = std::max(maxNum, ((ARegion*)elem)->num);
+	}
+
+	std::vector<std::vector<ARegion*>> groups;
+	std::vector<std::vector<bool>> claimed; ///< regions a group's battles may touch
+	forlist(&regions)
+	{
+		ARegion *r = (ARegion*)elem;
+
+		bool units = false;
+		forlist(&r->objects)
+		{
+			if (!((Object*)elem)->getUnits().empty())
+			{
+				units = true;
+				break;
+			}
+		}
+		if (!units)
+			continue;
+
+		std::vector<int> touched(1, r->num);
+		for (int i = 0; i < NDIRS; ++i)
+		{
+			if (r->neighbors[i])
+				touched.push_back(r->neighbors[i]->num);
+		}
+
+		// first group not touching any of these regions
+		size_t g = 0;
+		for (; g < groups.size(); ++g)
+		{
+			if (std::none_of(touched.begin(), touched.end(),
+			                 [&](int n) { return claimed[g][n]; }))
+				break;
+		}
+		if (g == groups.size())
+		{
+			groups.emplace_back();
+			claimed.emplace_back(maxNum + 1, false);
+		}
+
+		groups[g].push_back(r);
+		for (int n : touched)
+			claimed[g][n] = true;
+	}
+
+	for (auto &group : groups)
+	{
+		std::vector<FactionLog> logs(group.size());
+		std::atomic<unsigned> next(0);
+		auto workRegions = [this, key, work, seed, &group, &logs, &next]()
+		{
+			for (unsigned i = next++; i < group.size(); i = next++)
+			{
+				ARegion *r = group[i];
+				std::unique_ptr<RandomStream> stream(TakeStream({unsigned(key), unsigned(r->num)}));
+				if (!stream)
+					stream.reset(new RandomStream(seed ^ (unsigned(r->num) * 2654435761u)));
+
+				RandomStream::Use use(stream.get());
+				FactionLog::Use(&logs[i]);
+				(this->*work)(r);
+				FactionLog::Use(nullptr);
+			}
+		};
+
+		const int threads = std::min<int>(battleThreads, group.size());
+		std::vector<std::thread> pool;
+		for (int i = 1; i < threads; ++i)
+			pool.emplace_back(workRegions);
+
+		workRegions();
+
+		for (auto &t : pool)
+			t.join();
+
+		for (auto &log : logs)
+			log.Apply();
+	}
+}
+
 /*
  * Presume that u is alive, can attack, and wants to attack t.
  * Check that t is alive, u can see t, and u has enough riding
@@ -1661,16 +1796,48 @@ void Game::AttemptAttack(ARegion *r, Unit *u, Unit *t, int silent, int adv)
 	return;
 }
 
+///@return true if 'r' has a market of 'type'
+static bool HasMarket(ARegion *r, int type)
+{
+	forlist(&r->markets)
+	{
+		if (((Market*)elem)->type == type)
+			return true;
+	}
+	return false;
+}
+
 void Game::RunSellOrders()
 {
 	forlist((&regions))
 	{
 		ARegion *r = (ARegion*)elem;
-		forlist((&r->markets))
+
+		if (HasMarket(r, M_SELL))
 		{
-			Market *m = (Market*)elem;
-			if (m->type == M_SELL)
-				DoSell(r, m);
+			// group the orders by item for the markets
+			MarketOrders orders;
+			{
+				forlist(&r->objects)
+				{
+					Object *obj = (Object*)elem;
+					for (auto &u : obj->getUnits())
+					{
+						forlist(&u->sellorders)
+						{
+							SellOrder *o = (SellOrder*)elem;
+							orders.Add(o->item, u, o);
+						}
+					}
+				}
+			}
+
+			forlist((&r->markets))
+			{
+				Market *m = (Market*)elem;
+				if (m->type == M_SELL)
+					DoSell(r, m, orders);
+			}
 		}
 
 		{
@@ -1690,82 +1857,67 @@ void Game::RunSellOrders()
 	}
 }
 
-int Game::GetSellAmount(ARegion *r, Market *m)
+int Game::GetSellAmount(ARegion *r, Market *m, MarketOrders &orders)
 {
 	int num = 0;
-	forlist(&r->objects)
+	for (auto &e : orders.Get(m->item))
 	{
-		Object *obj = (Object*)elem;
-		for (auto &u : obj->getUnits())
+		Unit *u = e.unit;
+		SellOrder *o = (SellOrder*)e.order;
+
+		// sell all
+		const int can_sell = u->items.CanSell(o->item);
+		if (o->num == -1)
 		{
-			forlist (&u->sellorders)
-			{
-				SellOrder *o = (SellOrder*)elem;
-				if (o->item == m->item)
-				{
-					// sell all
-					const int can_sell = u->items.CanSell(o->item);
-					if (o->num == -1)
-					{
-						o->num = can_sell;
-					}
-					else if (o->num > can_sell)
-					{
-						o->num = can_sell;
-						u->Error("SELL: Unit attempted to sell more than it had.");
-					}
+			o->num = can_sell;
+		}
+		else if (o->num > can_sell)
+		{
+			o->num = can_sell;
+			u->Error("SELL: Unit attempted to sell more than it had.");
+		}
 
-					if (o->num < 0)
-						o->num = 0;
-					else
-						u->items.Selling(o->item, o->num);
+		if (o->num < 0)
+			o->num = 0;
+		else
+			u->items.Selling(o->item, o->num);
 
-					num += o->num;
-				}
-			}
-		}
+		num += o->num;
 	}
 	return num;
 }
 
-void Game::DoSell(ARegion *r, Market *m)
+void Game::DoSell(ARegion *r, Market *m, MarketOrders &orders)
 {
 	// First, find the number of items being sold
-	int attempted = std::max(m->amount, GetSellAmount(r, m));
+	int attempted = std::max(m->amount, GetSellAmount(r, m, orders));
 
 	m->activity = 0;
 	int oldamount = m->amount;
-	forlist(&r->objects)
+	std::vector<MarketOrders::Entry> &sells = orders.Get(m->item);
+	for (auto &e : sells)
 	{
-		Object *obj = (Object*)elem;
-		for (auto &u : obj->getUnits())
-		{
-			forlist(&u->sellorders)
-			{
-				SellOrder *o = (SellOrder*)elem;
-				// only handle sales of m->item
-				if (o->item != m->item)
-					continue;
+		Unit *u = e.unit;
+		SellOrder *o = (SellOrder*)e.order;
 
-				int temp = 0;
-				if (attempted)
-				{
-					temp = (m->amount * o->num + getrandom(attempted)) / attempted;
-					if (temp < 0) temp = 0;
-				}
-
-				attempted -= o->num;
-				m->amount -= temp;
-				m->activity += temp;
-				u->items.SetNum(o->item,u->items.GetNum(o->item) - temp);
-				u->SetMoney(u->GetMoney() + temp * m->price);
-				u->sellorders.Remove(o);
-				u->Event(AString("Sells ") + ItemString(o->item, temp)
-				   + " at $" + m->price + " each.");
-				delete o;
-			}
+		int temp = 0;
+		if (attempted)
+		{
+			temp = (m->amount * o->num + getrandom(attempted)) / attempted;
+			if (temp < 0) temp = 0;
 		}
+
+		attempted -= o->num;
+		m->amount -= temp;
+		m->activity += temp;
+		u->items.SetNum(o->item,u->items.GetNum(o->item) - temp);
+		u->SetMoney(u->GetMoney() + temp * m->price);
+		u->sellorders.Remove(o);
+		u->Event(AString("Sells ") + ItemString(o->item, temp)
+		   + " at $" + m->price + " each.");
+		delete o;
 	}
+	sells.clear();
 	m->amount = oldamount;
 }
 
@@ -1776,14 +1928,34 @@ void Game::RunBuyOrders()
 	{
 		ARegion *r = (ARegion*)elem;
 
-		//foreach market
-		forlist((&r->markets))
+		if (HasMarket(r, M_BUY))
 		{
-			Market *m = (Market*)elem;
+			// group the orders by item for the markets
+			MarketOrders orders;
+			{
+				forlist(&r->objects)
+				{
+					Object *obj = (Object*)elem;
+					for (auto &u : obj->getUnits())
+					{
+						forlist(&u->buyorders)
+						{
+							BuyOrder *o = (BuyOrder*)elem;
+							orders.Add(o->item, u, o);
+						}
+					}
+				}
+			}
 
-			// only process BUY orders
-			if (m->type == M_BUY)
-				DoBuy(r, m);
+			//foreach market
+			forlist((&r->markets))
+			{
+				Market *m = (Market*)elem;
+
+				// only process BUY orders
+				if (m->type == M_BUY)
+					DoBuy(r, m, orders);
+			}
 		}
 
 		// process remainder as errors (BUY orders should be empty now)
@@ -1808,102 +1980,101 @@ void Game::RunBuyOrders()
 	}
 }
 
-int Game::GetBuyAmount(ARegion *r, Market *m)
+int Game::GetBuyAmount(ARegion *r, Market *m, MarketOrders &orders)
 {
 	int num = 0;
-	forlist((&r->objects))
+	std::vector<MarketOrders::Entry> &buys = orders.Get(m->item);
+	std::size_t kept = 0;
+	for (auto &e : buys)
 	{
-		Object *obj = (Object*)elem;
-		for (auto &u : obj->getUnits())
+		Unit *u = e.unit;
+		BuyOrder *o = (BuyOrder*)e.order;
+
+		if (ItemDefs[o->item].type & IT_MAN)
 		{
-			forlist (&u->buyorders)
+			if (u->type == U_MAGE)
 			{
-				BuyOrder *o = (BuyOrder*)elem;
-				if (o->item == m->item)
-				{
-					if (ItemDefs[o->item].type & IT_MAN)
-					{
-						if (u->type == U_MAGE)
-						{
-							u->Error("BUY: Mages can't recruit more men.");
-							o->num = 0;
-						}
+				u->Error("BUY: Mages can't recruit more men.");
+				o->num = 0;
+			}
 
-						if (u->type == U_APPRENTICE)
-						{
-							u->Error("BUY: Apprentices can't recruit more men.");
-							o->num = 0;
-						}
+			if (u->type == U_APPRENTICE)
+			{
+				u->Error("BUY: Apprentices can't recruit more men.");
+				o->num = 0;
+			}
 
-						if ((o->item == I_LEADERS && u->IsNormal()) ||
-						    (o->item != I_LEADERS && u->IsLeader()))
-						 {
-							u->Error("BUY: Can't mix leaders and normal men.");
-							o->num = 0;
-						}
+			if ((o->item == I_LEADERS && u->IsNormal()) ||
+			    (o->item != I_LEADERS && u->IsLeader()))
+			 {
+				u->Error("BUY: Can't mix leaders and normal men.");
+				o->num = 0;
+			}
 
-						// check max skills
-						const int man_type = ItemDefs[o->item].index;
-						const int first_man_type = u->firstManType();
-						if (first_man_type != -1 && ManDefs[man_type].max_skills != ManDefs[first_man_type].max_skills)
-						{
-							u->Error("BUY: Can't mix men with different maximum number of skills.");
-							o->num = 0;
-						}
+			// check max skills
+			const int man_type = ItemDefs[o->item].index;
+			const int first_man_type = u->firstManType();
+			if (first_man_type != -1 && ManDefs[man_type].max_skills != ManDefs[first_man_type].max_skills)
+			{
+				u->Error("BUY: Can't mix men with different maximum number of skills.");
+				o->num = 0;
+			}
 
-						if (!isAlignCompat(ItemDefs[o->item].index, u->faction->alignments_))
-						{
-							u->Error("BUY: Can only buy units matching your alignment.");
-							o->num = 0;
-						}
-					}
+			if (!isAlignCompat(ItemDefs[o->item].index, u->faction->alignments_))
+			{
+				u->Error("BUY: Can only buy units matching your alignment.");
+				o->num = 0;
+			}
+		}
 
-					if (ItemDefs[o->item].type & IT_TRADE)
-					{
-						if( !TradeCheck( r, u->faction ))
-						{
-							u->Error( "BUY: Can't buy trade items in that many regions.");
-							o->num = 0;
-						}
-					}
+		if (ItemDefs[o->item].type & IT_TRADE)
+		{
+			if( !TradeCheck( r, u->faction ))
+			{
+				u->Error( "BUY: Can't buy trade items in that many regions.");
+				o->num = 0;
+			}
+		}
 
-					// figure out how much money the unit can get
-					const int max_money = (o->num == -1) ? -1 : o->num * m->price;
-					const int unit_money = u->canConsume(I_SILVER, max_money);
+		// figure out how much money the unit can get
+		const int max_money = (o->num == -1) ? -1 : o->num * m->price;
+		const int unit_money = u->canConsume(I_SILVER, max_money);
 
-					// if buy max
-					if (o->num == -1)
-					{
-						o->num = unit_money / m->price;
-					}
+		// if buy max
+		if (o->num == -1)
+		{
+			o->num = unit_money / m->price;
+		}
 
-					if (o->num * m->price > unit_money)
-					{
-						o->num = unit_money / m->price;
-						u->Error("BUY: Unit attempted to buy more than it could afford.");
-					}
-					num += o->num;
-				}
+		if (o->num * m->price > unit_money)
+		{
+			o->num = unit_money / m->price;
+			u->Error("BUY: Unit attempted to buy more than it could afford.");
+		}
+		num += o->num;
 
-				if (o->num < 1 && o->num != -1)
-				{
-					u->buyorders.Remove(o);
-					delete o;
-				}
-			}
+		if (o->num < 1 && o->num != -1)
+		{
+			u->buyorders.Remove(o);
+			delete o;
+		}
+		else
+		{
+			buys[kept++] = e;
 		}
 	}
+	buys.resize(kept);
 
 	return num;
 }
 
-void Game::DoBuy(ARegion *r, Market *m)
+void Game::DoBuy(ARegion *r, Market *m, MarketOrders &orders)
 {
 	// clear accumulator
 	m->activity = 0;
 
 	// First, find the number of items being purchased
-	int attempted = GetBuyAmount(r,m);
+	int attempted = GetBuyAmount(r, m, orders);
 	if (!attempted)
 		return; // nothing to do
 
@@ -1914,87 +2085,132 @@ void Game::DoBuy(ARegion *r, Market *m)
 	// save amount available
 	const int oldamount = m->amount;
 
-	forlist(&r->objects)
+	std::vector<MarketOrders::Entry> &buys = orders.Get(m->item);
+	for (auto &e : buys)
 	{
-		Object *obj = (Object*)elem;
-		for (auto &u : obj->getUnits())
+		Unit *u = e.unit;
+		BuyOrder *o = (BuyOrder*)e.order;
+
+		const int max_money = (o->num == -1) ? -1 : o->num * m->price;
+		const int unit_money = u->canConsume(I_SILVER, max_money);
+
+		int temp = o->num;
+		if (temp * m->price > unit_money)
+		{
+			temp = unit_money / m->price;
+		}
+
+		// if not unlimited market
+		if (m->amount != -1)
 		{
-			forlist(&u->buyorders)
+			if (attempted)
 			{
-				BuyOrder *o = (BuyOrder*)elem;
-				if (o->item != m->item)
-					continue;
+				temp = (m->amount * temp +
+				      getrandom(attempted)) / attempted;
 
-				const int max_money = (o->num == -1) ? -1 : o->num * m->price;
-				const int unit_money = u->canConsume(I_SILVER, max_money);
+				if (temp < 0)
+					temp = 0;
+			}
+			attempted -= o->num;
+			m->amount -= temp;
+			m->activity += temp;
+		}
 
-				int temp = o->num;
-				if (temp * m->price > unit_money)
-				{
-					temp = unit_money / m->price;
-				}
+		if (ItemDefs[o->item].type & IT_MAN)
+		{
+			// recruiting; must dilute skills
+			u->AdjustSkills();
+		}
+		u->items.SetNum(o->item,u->items.GetNum(o->item) + temp);
 
-				// if not unlimited market
-				if (m->amount != -1)
-				{
-					if (attempted)
-					{
-						temp = (m->amount * temp +
-						      getrandom(attempted)) / attempted;
+		u->consume(I_SILVER, temp * m->price);
 
-						if (temp < 0)
-							temp = 0;
-					}
-					attempted -= o->num;
-					m->amount -= temp;
-					m->activity += temp;
-				}
+		u->Event(AString("Buys ") + ItemString(o->item,temp)
+		      + " at $" + m->price + " each.");
 
-				if (ItemDefs[o->item].type & IT_MAN)
-				{
-					// recruiting; must dilute skills
-					u->AdjustSkills();
-				}
-				u->items.SetNum(o->item,u->items.GetNum(o->item) + temp);
+		// send a message about the item, if it is unknown
+		u->faction->DiscoverItem(o->item, 0, 1);
 
-				u->consume(I_SILVER, temp * m->price);
+		u->buyorders.Remove(o);
+		delete o;
+	}
+	buys.clear();
 
-				u->Event(AString("Buys ") + ItemString(o->item,temp)
-				      + " at $" + m->price + " each.");
+	m->amount = oldamount;
+}
 
-				// send a message about the item, if it is unknown
-				u->faction->DiscoverItem(o->item, 0, 1);
+void Game::CheckUnitMaintenanceItem(Upkeep &upkeep, int item, int value, int consume)
+{
+	for (auto &ledger : upkeep.regions)
+	{
+		for (UpkeepStock *s : ledger.Stocks(item))
+		{
+			Unit *u = s->unit;
+			if (u->needed > 0 &&
+			    (!consume ||
+			     u->GetFlag(FLAG_CONSUMING_UNIT) ||
+			     u->GetFlag(FLAG_CONSUMING_FACTION)
+			    )
+			)
+			{
+				int amount = s->num;
+				if (!amount)
+					continue;
 
-				u->buyorders.Remove(o);
-				delete o;
+				int eat = (u->needed + value - 1) / value;
+				if (eat > amount)
+					eat = amount;
+
+				if (ItemDefs[item].type & IT_FOOD)
+				{
+					if (Globals->UPKEEP_MAXIMUM_FOOD >= 0 &&
+					    eat * value > u->stomach_space)
+					{
+						eat = (u->stomach_space + value - 1) / value;
+						if (eat < 0)
+							eat = 0;
+					}
+					u->hunger -= eat * value;
+					u->stomach_space -= eat * value;
+					if (Globals->UPKEEP_MAXIMUM_FOOD >= 0 &&
+					    u->stomach_space < 0)
+					{
+						u->needed -= u->stomach_space;
+						u->stomach_space = 0;
+					}
+				}
+				u->needed -= eat * value;
+				ledger.Take(item, *s, eat);
 			}
 		}
 	}
-
-	m->amount = oldamount;
 }
 
-void Game::CheckUnitMaintenanceItem(int item, int value, int consume)
+void Game::CheckFactionMaintenanceItem(Upkeep &upkeep, int item, int value, int consume)
 {
-	forlist(&regions)
+	for (auto &ledger : upkeep.regions)
 	{
-		ARegion *r = (ARegion*)elem;
-		forlist(&r->objects)
+		for (Unit *u : ledger.units)
 		{
-			Object *obj = (Object*)elem;
-			for (auto &u : obj->getUnits())
+			if (u->needed > 0 &&
+			    (!consume ||
+			     u->GetFlag(FLAG_CONSUMING_FACTION))
+			)
 			{
-				if (u->needed > 0 &&
-				    (!consume ||
-				     u->GetFlag(FLAG_CONSUMING_UNIT) ||
-				     u->GetFlag(FLAG_CONSUMING_FACTION)
-				    )
-				)
+				UpkeepList &stocks = ledger.Stocks(item, u->faction);
+				if (!stocks.Total())
+					continue;
+
+				// Go through the other units of the faction holding the
+				// item, until the unit is fed once done with an object
+				int object = -1;
+				for (UpkeepStock *s : stocks)
 				{
-					int amount = u->items.GetNum(item);
-					if (!amount)
-						continue;
+					if (u->needed < 1 && s->object != object) break;
+					if (s->unit == u || !s->num) continue;
+					object = s->object;
 
+					int amount = s->num;
 					int eat = (u->needed + value - 1) / value;
 					if (eat > amount)
 						eat = amount;
@@ -2018,164 +2234,131 @@ void Game::CheckUnitMaintenanceItem(int item, int value, int consume)
 						}
 					}
 					u->needed -= eat * value;
-					u->items.SetNum(item, amount - eat);
+					ledger.Take(item, *s, eat);
 				}
 			}
 		}
 	}
 }
 
-void Game::CheckFactionMaintenanceItem(int item, int value, int consume)
+void Game::CheckAllyMaintenanceItem(Upkeep &upkeep, int item, int value)
 {
-	forlist(&regions)
+	for (auto &ledger : upkeep.regions)
 	{
-		ARegion *r = (ARegion*)elem;
-		forlist(&r->objects)
+		ARegion *r = ledger.region;
+		for (Unit *u : ledger.units)
 		{
-			Object *obj = (Object*)elem;
-			for (auto &u : obj->getUnits())
+			if (u->needed <= 0)
+				continue;
+
+			// Go through the allied units holding the item, until the unit
+			// is fed once done with an object
+			int object = -1;
+			for (const UpkeepAllies::Entry &e : ledger.Allies(item, u->faction))
 			{
-				if (u->needed > 0 &&
-				    (!consume ||
-				     u->GetFlag(FLAG_CONSUMING_FACTION))
-				)
+				UpkeepStock *s = e.stock;
+				if (u->needed < 1 && s->object != object) break;
+				Unit *u2 = s->unit;
+				if (!s->num || (e.check && u2->GetAttitude(r,u) != A_ALLY))
+					continue;
+				object = s->object;
+
+				int amount = s->num;
+				int eat = (u->needed + value - 1) / value;
+				if (eat > amount)
+					eat = amount;
+				if (ItemDefs[item].type & IT_FOOD)
 				{
-					// Go through all units again
-					forlist(&r->objects)
+					if (Globals->UPKEEP_MAXIMUM_FOOD >= 0 &&
+					    eat * value > u->stomach_space)
 					{
-						Object *obj2 = (Object*)elem;
-						for (auto &u2 : obj2->getUnits())
-						{
-							if (u->faction == u2->faction && u != u2)
-							{
-								int amount = u2->items.GetNum(item);
-								if (amount)
-								{
-									int eat = (u->needed + value - 1) / value;
-									if (eat > amount)
-										eat = amount;
-
-									if (ItemDefs[item].type & IT_FOOD)
-									{
-										if (Globals->UPKEEP_MAXIMUM_FOOD >= 0 &&
-										    eat * value > u->stomach_space)
-										{
-											eat = (u->stomach_space + value - 1) / value;
-											if (eat < 0)
-												eat = 0;
-										}
-										u->hunger -= eat * value;
-										u->stomach_space -= eat * value;
-										if (Globals->UPKEEP_MAXIMUM_FOOD >= 0 &&
-										    u->stomach_space < 0)
-										{
-											u->needed -= u->stomach_space;
-											u->stomach_space = 0;
-										}
-									}
-									u->needed -= eat * value;
-									u2->items.SetNum(item, amount - eat);
-								}
-							}
-						}
-
-						if (u->needed < 1) break;
+						eat = (u->stomach_space + value - 1) / value;
+						if (eat < 0)
+							eat = 0;
+					}
+					u->hunger -= eat * value;
+					u->stomach_space -= eat * value;
+					if (Globals->UPKEEP_MAXIMUM_FOOD >= 0 &&
+					    u->stomach_space < 0)
+					{
+						u->needed -= u->stomach_space;
+						u->stomach_space = 0;
 					}
 				}
+				if (eat)
+				{
+					u->needed -= eat * value;
+					ledger.Take(item, *s, eat);
+					u2->Event(*(u->name) + " borrows " +
+					          ItemString(item, eat) +
+					          " for maintenance.");
+					u->Event(AString("Borrows ") +
+					         ItemString(item, eat) +
+					         " from " + *(u2->name) +
+					         " for maintenance.");
+				}
 			}
 		}
 	}
 }
 
-void Game::CheckAllyMaintenanceItem(int item, int value)
+void Game::CheckUnitHungerItem(Upkeep &upkeep, int item, int value)
 {
-	forlist(&regions)
+	for (auto &ledger : upkeep.regions)
 	{
-		ARegion *r = (ARegion*)elem;
-		forlist(&r->objects)
+		for (UpkeepStock *s : ledger.Stocks(item))
 		{
-			Object *obj = (Object*)elem;
-			for (auto &u : obj->getUnits())
-			{
-				if (u->needed <= 0)
-					continue;
+			Unit *u = s->unit;
+			if (u->hunger <= 0)
+				continue;
 
-				// Go through all units again
-				forlist(&r->objects)
-				{
-					Object *obj2 = (Object*)elem;
-					{
-						for (auto &u2 : obj2->getUnits())
-						{
-							if (u->faction != u2->faction &&
-							    u2->GetAttitude(r,u) == A_ALLY)
-							{
-								int amount = u2->items.GetNum(item);
-								if (amount)
-								{
-									int eat = (u->needed + value - 1) / value;
-									if (eat > amount)
-										eat = amount;
-									if (ItemDefs[item].type & IT_FOOD)
-									{
-										if (Globals->UPKEEP_MAXIMUM_FOOD >= 0 &&
-										    eat * value > u->stomach_space)
-										{
-											eat = (u->stomach_space + value - 1) / value;
-											if (eat < 0)
-												eat = 0;
-										}
-										u->hunger -= eat * value;
-										u->stomach_space -= eat * value;
-										if (Globals->UPKEEP_MAXIMUM_FOOD >= 0 &&
-										    u->stomach_space < 0)
-										{
-											u->needed -= u->stomach_space;
-											u->stomach_space = 0;
-										}
-									}
-									if (eat)
-									{
-										u->needed -= eat * value;
-										u2->items.SetNum(item, amount - eat);
-										u2->Event(*(u->name) + " borrows " +
-										          ItemString(item, eat) +
-										          " for maintenance.");
-										u->Event(AString("Borrows ") +
-										         ItemString(item, eat) +
-										         " from " + *(u2->name) +
-										         " for maintenance.");
-										u2->items.SetNum(item, amount - eat);
-									}
-								}
-							}
-						}
+			int amount = s->num;
+			if (!amount)
+				continue;
 
-						if (u->needed < 1) break;
-					}
-				}
+			int eat = (u->hunger + value - 1) / value;
+			if (eat > amount)
+				eat = amount;
+
+			u->hunger -= eat * value;
+			u->stomach_space -= eat * value;
+			u->needed -= eat * value;
+
+			if (Globals->UPKEEP_MAXIMUM_FOOD >= 0 &&
+			    u->stomach_space < 0)
+			{
+				u->needed -= u->stomach_space;
+				u->stomach_space = 0;
 			}
+
+			ledger.Take(item, *s, eat);
 		}
 	}
 }
 
-void Game::CheckUnitHungerItem(int item, int value)
+void Game::CheckFactionHungerItem(Upkeep &upkeep, int item, int value)
 {
-	forlist(&regions)
+	for (auto &ledger : upkeep.regions)
 	{
-		ARegion *r = (ARegion*)elem;
-		forlist(&r->objects)
+		for (Unit *u : ledger.units)
 		{
-			Object *obj = (Object*)elem;
-			for (auto &u : obj->getUnits())
-			{
-				if (u->hunger <= 0)
-					continue;
+			if (u->hunger <= 0)
+				continue;
 
-				int amount = u->items.GetNum(item);
-				if (!amount)
-					continue;
+			UpkeepList &stocks = ledger.Stocks(item, u->faction);
+			if (!stocks.Total())
+				continue;
+
+			// Go through the other units of the faction holding the item,
+			// until the unit is fed once done with an object
+			int object = -1;
+			for (UpkeepStock *s : stocks)
+			{
+				if (u->hunger < 1 && s->object != object) break;
+				if (s->unit == u || !s->num) continue;
+				object = s->object;
 
+				const int amount = s->num;
 				int eat = (u->hunger + value - 1) / value;
 				if (eat > amount)
 					eat = amount;
@@ -2191,113 +2374,55 @@ void Game::CheckUnitHungerItem(int item, int value)
 					u->stomach_space = 0;
 				}
 
-				u->items.SetNum(item, amount - eat);
+				ledger.Take(item, *s, eat);
 			}
 		}
 	}
 }
 
-void Game::CheckFactionHungerItem(int item, int value)
+void Game::CheckAllyHungerItem(Upkeep &upkeep, int item, int value)
 {
-	forlist(&regions)
+	for (auto &ledger : upkeep.regions)
 	{
-		ARegion *r = (ARegion*)elem;
-		forlist(&r->objects)
+		ARegion *r = ledger.region;
+		for (Unit *u : ledger.units)
 		{
-			Object *obj = (Object*)elem;
-			for (auto &u : obj->getUnits())
+			if (u->hunger <= 0)
+				continue;
+
+			// Go through the allied units holding the item, until the unit
+			// is fed once done with an object
+			int object = -1;
+			for (const UpkeepAllies::Entry &e : ledger.Allies(item, u->faction))
 			{
-				if (u->hunger <= 0)
+				UpkeepStock *s = e.stock;
+				if (u->hunger < 1 && s->object != object) break;
+				Unit *u2 = s->unit;
+				if (!s->num || (e.check && u2->GetAttitude(r,u) != A_ALLY))
 					continue;
+				object = s->object;
 
-				// Go through all units again
-				forlist(&r->objects)
-				{
-					Object *obj2 = (Object*)elem;
-					for (auto &u2 : obj2->getUnits())
-					{
-						if (u->faction == u2->faction && u != u2)
-						{
-							const int amount = u2->items.GetNum(item);
-							if (amount)
-							{
-								int eat = (u->hunger + value - 1) / value;
-								if (eat > amount)
-									eat = amount;
-
-								u->hunger -= eat * value;
-								u->stomach_space -= eat * value;
-								u->needed -= eat * value;
-
-								if (Globals->UPKEEP_MAXIMUM_FOOD >= 0 &&
-								    u->stomach_space < 0)
-								{
-									u->needed -= u->stomach_space;
-									u->stomach_space = 0;
-								}
-
-								u2->items.SetNum(item, amount - eat);
-							}
-						}
-					}
-
-					if (u->hunger < 1) break;
-				}
-			}
-		}
-	}
-}
-
-void Game::CheckAllyHungerItem(int item, int value)
-{
-	forlist(&regions)
-	{
-		ARegion * r = (ARegion *) elem;
-		forlist((&r->objects))
-		{
-			Object * obj = (Object *) elem;
-			for (auto &u : obj->getUnits())
-			{
-				if (u->hunger > 0)
+				int amount = s->num;
+				int eat = (u->hunger + value - 1) / value;
+				if (eat > amount)
+					eat = amount;
+				u->hunger -= eat * value;
+				u->stomach_space -= eat * value;
+				u->needed -= eat * value;
+				if (Globals->UPKEEP_MAXIMUM_FOOD >= 0 &&
+					u->stomach_space < 0)
 				{
-					// Go through all units again
-					forlist((&r->objects)) {
-						Object * obj2 = (Object *) elem;
-						for (auto &u2 : obj2->getUnits())
-						{
-							if (u->faction != u2->faction &&
-							   u2->GetAttitude(r,u) == A_ALLY)
-							{
-								int amount = u2->items.GetNum(item);
-								if (amount) {
-									int eat = (u->hunger + value - 1) / value;
-									if (eat > amount)
-										eat = amount;
-									u->hunger -= eat * value;
-									u->stomach_space -= eat * value;
-									u->needed -= eat * value;
-									if (Globals->UPKEEP_MAXIMUM_FOOD >= 0 &&
-										u->stomach_space < 0)
-									{
-										u->needed -= u->stomach_space;
-										u->stomach_space = 0;
-									}
-									u2->items.SetNum(item, amount - eat);
-									    u2->Event(*(u->name) + " borrows " +
-									              ItemString(item, eat) +
-									              " to fend off starvation.");
-									    u->Event(AString("Borrows ") +
-									             ItemString(item, eat) +
-									             " from " + *(u2->name) +
-									             " to fend off starvation.");
-									    u2->items.SetNum(item, amount - eat);
-								}
-							}
-						}
-
-						if (u->hunger < 1) break;
-					}
+					u->needed -= u->stomach_space;
+					u->stomach_space = 0;
 				}
+				ledger.Take(item, *s, eat);
+				u2->Event(*(u->name) + " borrows " +
+				          ItemString(item, eat) +
+				          " to fend off starvation.");
+				u->Event(AString("Borrows ") +
+				         ItemString(item, eat) +
+				         " from " + *(u2->name) +
+				         " to fend off starvation.");
 			}
 		}
 	}
@@ -2327,11 +2452,14 @@ void Game::AssessMaintenance()
 		}
 	}
 
+	// Who holds food and silver, kept up to date as they are used up
+	Upkeep upkeep(regions, {I_SILVER, I_FOOD, I_GRAIN, I_LIVESTOCK, I_FISH});
+
 	// Assess food requirements first
 	if (Globals->UPKEEP_MINIMUM_FOOD > 0)
 	{
-		CheckUnitHunger();
-		CheckFactionHunger();
+		CheckUnitHunger(upkeep);
+		CheckFactionHunger(upkeep);
 		if (Globals->ALLOW_WITHDRAW)
 		{
 			// Can claim food for maintenance, so find the cheapest food
@@ -2389,29 +2517,29 @@ void Game::AssessMaintenance()
 				}
 			}
 		}
-		CheckAllyHunger();
+		CheckAllyHunger(upkeep);
 	}
 
 	// Check for CONSUMEing units.
 	if (Globals->FOOD_ITEMS_EXIST)
 	{
-		CheckUnitMaintenance(1);
-		CheckFactionMaintenance(1);
+		CheckUnitMaintenance(upkeep, 1);
+		CheckFactionMaintenance(upkeep, 1);
 	}
 
 	// Check the unit for money.
-	CheckUnitMaintenanceItem(I_SILVER, 1, 0);
+	CheckUnitMaintenanceItem(upkeep, I_SILVER, 1, 0);
 
 	// Check other units in same faction for money
-	CheckFactionMaintenanceItem(I_SILVER, 1, 0);
+	CheckFactionMaintenanceItem(upkeep, I_SILVER, 1, 0);
 
 	if (Globals->FOOD_ITEMS_EXIST)
 	{
 		// Check unit for possible food items.
-		CheckUnitMaintenance(0);
+		CheckUnitMaintenance(upkeep, 0);
 
 		// Fourth pass; check other units in same faction for food items
-		CheckFactionMaintenance(0);
+		CheckFactionMaintenance(upkeep, 0);
 	}
 
 	// Check unclaimed money
@@ -2449,12 +2577,12 @@ void Game::AssessMaintenance()
 	}
 
 	// Check other allied factions for $$$.
-	CheckAllyMaintenanceItem(I_SILVER, 1);
+	CheckAllyMaintenanceItem(upkeep, I_SILVER, 1);
 
 	if (Globals->FOOD_ITEMS_EXIST)
 	{
 		// Check other factions for food items.
-		CheckAllyMaintenance();
+		CheckAllyMaintenance(upkeep);
 	}
 
 	// Last, if the unit still needs money, starve some men.
@@ -2582,7 +2710,7 @@ void Game::DoGiveOrders()
 			Object *obj = (Object*)elem;
 
 			//foreach unit in object
-			for (auto &u : obj->getUnits())
+			for (auto &u : obj->snapshotUnits())
 			{
 				//foreach give order
 				forlist(&u->giveorders)
@@ -3420,7 +3548,7 @@ void Game::DeleteEmptyInRegion(ARegion *region)
 	forlist(&region->objects)
 	{
 		Object *obj = (Object*)elem;
-		for (auto &unit : obj->getUnits())
+		for (auto &unit : obj->snapshotUnits())
 		{
 			if (unit->IsAlive() == 0)
 			{
@@ -0,0 +1,58 @@
+// START A3HEADER
+//
+// This source file is part of the Atlantis PBM game program.
+// Copyright (C) 1995-1999 Geoff Dunbar
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program, in the file license.txt. If not, write
+// to the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+// Boston, MA 02111-1307, USA.
+//
+// See the Atlantis Project web page for details:
+// http://www.prankster.com/project
+//
+// END A3HEADER
+
+// Battle simulator: fights a battle described in a file many times, for
+// timing and balancing.  It is linked with each rule set next to the game
+// program (see the battlesim targets in the Makefile).  It exits with 1 if the battle file can't be fought, or if
+// the battle engines disagree, so a suite of battle files can be run from
+// a script.
+#include "game.h"
+#include "gameio.h"
+#include "astring.h"
+
+int main(int argc, const char *argv[])
+{
+	Game game;
+
+	initIO();
+
+	if (argc < 2 || argc > 5 || (argc == 5 && !(AString(argv[4]) == "compare"))) {
+		Awrite("battlesim <battlefile> [<runs> [<seed> [compare]]]");
+		doneIO();
+		return 1;
+	}
+
+	game.ModifyTablesPerRuleset();
+	game.resolveBackRefs();
+
+	const int runs = argc > 2 ? AString(argv[2]).value() : 100;
+	const int seed = argc > 3 ? AString(argv[3]).value() : 1;
+
+	// (SimulateBattles says what went wrong)
+	const int ok = game.SimulateBattles(argv[1], runs, seed, argc == 5);
+
+	doneIO();
+	return ok ? 0 : 1;
+}
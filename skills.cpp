@@ -28,6 +28,7 @@
 #include "gamedefs.h"
 #include "fileio.h"
 #include "astring.h"
+#include "keywordindex.h"
 
 int itemForSkill(int skill)
 {
@@ -51,19 +52,27 @@ int itemForSkill(int skill)
 
 int ParseSkill(const AString *token)
 {
-	for (int i = 0; i < NSKILLS; ++i)
-	{
-		if (*token == SkillDefs[i].name ||
-		    *token == SkillDefs[i].abbr)
+	// names never change, so the index can be built once
+	static const AKeywordIndex skills = [] {
+		AKeywordIndex idx;
+		for (int i = 0; i < NSKILLS; ++i)
 		{
-			if (SkillDefs[i].flags & SkillType::DISABLED)
-				return -1;
-
-			return i;
+			idx.add(SkillDefs[i].name, i);
+			idx.add(SkillDefs[i].abbr, i);
 		}
-	}
+		return idx;
+	}();
 
-	return -1;
+	const std::vector<int> *found = skills.find(*token);
+	if (!found)
+		return -1;
+
+	// the first match decides, even if it is disabled
+	const int i = found->front();
+	if (SkillDefs[i].flags & SkillType::DISABLED)
+		return -1;
+
+	return i;
 }
 
 AString SkillStrs(int i)
@@ -159,57 +168,93 @@ Skill* Skill::Split(int total, int leave)
 }
 
 //----------------------------------------------------------------------------
-int SkillList::GetDays(int skill)
+///@return index of the first of the 'n' skills in 'a' (sorted by type)
+/// which is not before 'skill'
+static unsigned FirstOf(Skill *const *a, unsigned n, int skill)
 {
-	forlist(this)
+	unsigned first = 0;
+	while (n)
 	{
-		const Skill *const s = (Skill*)elem;
-		if (s->type == skill)
-			return s->days;
+		const unsigned half = n / 2;
+		if (a[first + half]->type < skill)
+		{
+			first += half + 1;
+			n -= half + 1;
+		}
+		else
+		{
+			n = half;
+		}
 	}
-	return 0;
+	return first;
+}
+
+Skill* SkillList::find(int skill) const
+{
+	const unsigned i = FirstOf(index_.data(), index_.size(), skill);
+	return (i < index_.size() && index_[i]->type == skill) ? index_[i] : nullptr;
+}
+
+void SkillList::add(Skill *s)
+{
+	++version_;
+	Add(s);
+	const unsigned i = FirstOf(index_.data(), index_.size(), s->type);
+	index_.insert(index_.begin() + i, s);
+}
+
+void SkillList::erase(Skill *s)
+{
+	++version_;
+	const unsigned i = FirstOf(index_.data(), index_.size(), s->type);
+	index_.erase(index_.begin() + i);
+	Remove(s);
+	delete s;
+}
+
+void SkillList::deleteAll()
+{
+	++version_;
+	index_.clear();
+	AList::deleteAll();
+}
+
+int SkillList::GetDays(int skill)
+{
+	const Skill *s = find(skill);
+	return s ? s->days : 0;
 }
 
 void SkillList::SetDays(int skill, int days)
 {
-	//foreach skill known
-	forlist(this)
+	// look for the given skill
+	if (Skill *s = find(skill))
 	{
-		// look for the given skill
-		Skill *s = (Skill*)elem;
-		if (s->type != skill)
-			continue;
-
 		if (days == 0)
-		{
-			Remove(s);
-			delete s;
-			return;
-		}
-		//else
-		s->days = days;
+			erase(s);
+		else
+			s->days = days;
+		++version_;
 		return;
 	}
 	//else new skill
 
 	if (days != 0)
-		Add(new Skill(skill, days));
+		add(new Skill(skill, days));
 }
 
 SkillList* SkillList::Split(int total, int leave)
 {
 	SkillList *ret = new SkillList;
+	++version_;
 	forlist(this)
 	{
 		Skill *s = (Skill*)elem;
 
 		Skill *n = s->Split(total, leave);
 		if (s->days == 0)
-		{
-			Remove(s);
-			delete s;
-		}
-		ret->Add(n);
+			erase(s);
+		ret->add(n);
 	}
 	return ret;
 }
@@ -255,9 +300,20 @@ void SkillList::Readin(Ainfile *f)
 		s->Readin(f);
 
 		if (s->days == 0)
+		{
 			delete s;
+		}
+		else if (Skill *had = find(s->type))
+		{
+			// (listed twice) keep one skill of each type
+			had->days += s->days;
+			++version_;
+			delete s;
+		}
 		else
-			Add(s);
+		{
+			add(s);
+		}
 	}
 }
 
@@ -25,6 +25,7 @@
 //
 // END A3HEADER
 #include "alist.h"
+#include <vector>
 
 class Ainfile;
 class Aoutfile;
@@ -156,6 +157,40 @@ public:
 
 	/// set days of study for 'skill' to 'new_days' (0 to remove)
 	void SetDays(int skill, int new_days);
+
+	/// delete all skills
+	void DeleteAll() { deleteAll(); }
+	void deleteAll();
+
+	///@return a count which moves on whenever the skills change
+	unsigned Version() const { return version_; }
+
+	/// note that a skill's days were changed in place
+	void Touched() { ++version_; }
+
+private:
+	///@return the skill of type 'skill', or NULL
+	Skill* find(int skill) const;
+
+	/// put 's' at the end of the list
+	void add(Skill *s);
+
+	/// take 's' out of the list and delete it
+	void erase(Skill *s);
+
+	// the list only changes through add() and erase(), which keep the index
+	using AList::Add;
+	using AList::push_back;
+	using AList::Insert;
+	using AList::push_front;
+	using AList::Remove;
+	using AList::remove;
+	using AList::Empty;
+	using AList::clear;
+
+private:
+	std::vector<Skill*> index_; ///< the skills sorted by type, for lookups
+	unsigned version_ = 0;      ///< see Version()
 };
 
 int itemForSkill(int skill);
@@ -202,6 +202,9 @@ void Battle::DoSpecialAttack(int round, Soldier *a, Army *attackers,
 	if (!(spd->effectflags & SpecialType::FX_DAMAGE))
 		return;
 
+	BattleTimer timer(profile, BP_SPECIALS);
+	++profile.specials;
+
 	int tot = -1;
 	AString results[4];
 	int dam = 0;
@@ -242,11 +245,11 @@ void Battle::DoSpecialAttack(int round, Soldier *a, Army *attackers,
 
 	if (tot == -1)
 	{
-		AddLine(a->name + " " + spd->spelldesc + ", but it is deflected.");
+		AddLine(*a->name + " " + spd->spelldesc + ", but it is deflected.");
 		return;
 	}
 
-	AString temp = a->name + " " + spd->spelldesc;
+	AString temp = *a->name + " " + spd->spelldesc;
 
 	if (spd->effectflags & SpecialType::FX_DONT_COMBINE)
 	{
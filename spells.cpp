@@ -1816,30 +1816,30 @@ void Game::RunPortalLore(ARegion *r,Object *o,Unit *u)
 	}
 
 	// gate is actually a unit num
-	Location *tar = regions.FindUnit(order->gate);
-	if (!tar) {
+	Location tar;
+	if (!FindUnit(order->gate, &tar)) {
 		u->Error("CAST: No such target mage.");
 		return;
 	}
 
 	// check target unit
-	if (tar->unit->faction->GetAttitude(u->faction->num) < A_FRIENDLY) {
+	if (tar.unit->faction->GetAttitude(u->faction->num) < A_FRIENDLY) {
 		u->Error("CAST: Target mage is not friendly.");
 		return;
 	}
 
-	if (tar->unit->type != U_MAGE && tar->unit->type != U_APPRENTICE) {
+	if (tar.unit->type != U_MAGE && tar.unit->type != U_APPRENTICE) {
 		u->Error("CAST: Target is not a mage.");
 		return;
 	}
 
-	if (!tar->unit->items.GetNum(I_PORTAL)) {
+	if (!tar.unit->items.GetNum(I_PORTAL)) {
 		u->Error("CAST: Target does not have a Portal.");
 		return;
 	}
 
 	const int maxdist = 2 * level * level;
-	if (regions.GetDistance(r, tar->region) > maxdist) {
+	if (regions.GetDistance(r, tar.region) > maxdist) {
 		u->Error("CAST: Can't Portal Jump that far.");
 		return;
 	}
@@ -1864,12 +1864,12 @@ void Game::RunPortalLore(ARegion *r,Object *o,Unit *u)
 			else
 			{
 				loc->unit->Event(AString("Is teleported to ") +
-						tar->region->Print( &regions ) +
+						tar.region->Print( &regions ) +
 						" by " + *u->name + ".");
 
 				// Unit cannot instantly guard the destination
 				loc->unit->guard = GUARD_NONE;
-				loc->unit->MoveUnit( tar->obj );
+				loc->unit->MoveUnit( tar.obj );
 
 				if (loc->unit != u)
 					loc->unit->ClearCastOrders();
@@ -1878,8 +1878,6 @@ void Game::RunPortalLore(ARegion *r,Object *o,Unit *u)
 			delete loc;
 		}
 	}
-
-	delete tar;
 }
 
 void Game::RunTeleportOrders()
@@ -1891,7 +1889,7 @@ void Game::RunTeleportOrders()
 			int foundone = 1;
 			while (foundone) {
 				foundone = 0;
-				for (auto &u : o->getUnits())
+				for (auto &u : o->snapshotUnits())
 				{
 					if (u->teleportorders)
 					{
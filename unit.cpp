@@ -943,10 +943,7 @@ void Unit::PostTurn(ARegion *r)
 		{
 			Item *i = (Item*)elem;
 			if (!(ItemDefs[i->type].type & IT_MONSTER))
-			{
-				items.Remove(i);
-				delete i;
-			}
+				items.SetNum(i->type, 0);
 		}
 
 		if (free > 0)
@@ -1021,39 +1018,276 @@ void Unit::SetMen(int t, int n)
 	}
 }
 
-int Unit::GetMons()
+//----------------------------------------------------------------------------
+// stats worked out from scratch (Unit::workOut)
+
+///@return number of items in 'items' whose ItemType has 'flag' set in type
+static int CountOf(ItemList &items, int flag)
 {
 	int n = 0;
 	forlist(&items)
 	{
 		const Item *i = (const Item*)elem;
 
-		if (ItemDefs[i->type].type & IT_MONSTER)
+		if (ItemDefs[i->type].type & flag)
 			n += i->num;
 	}
 
 	return n;
 }
 
-int Unit::GetMen(int t)
+///@return sum of 'cap' (a capacity of ItemType) over 'items'
+static int CapacityOf(ItemList &items, int ItemType::*cap)
 {
-	return items.GetNum(t);
+	int n = 0;
+	forlist(&items)
+	{
+		const Item *i = (const Item*)elem;
+		n += ItemDefs[i->type].*cap * i->num;
+	}
+
+	return n;
 }
 
-int Unit::GetMen()
+///@return walking capacity of 'items', with the pullable items that can be
+/// pulled
+static int WalkingCapacityOf(ItemList &items)
+{
+	int cap = 0;
+	std::map<int, int> used_items;  // pulling/pullable itmes (e.g. horses, camels, wagon, etc)
+
+	forlist(&items)
+	{
+		Item *i = (Item*)elem;
+
+		cap += ItemDefs[i->type].walk * i->num;
+
+		// Add capacity of pullable items (wagons, etc)
+		for (unsigned c = 0; c < ItemDefs[i->type].hitchItems.size(); ++c)
+		{
+			const HitchItem &pulling_item = ItemDefs[i->type].hitchItems[c];
+
+			// No pulling item specified
+			if (pulling_item.item == -1)
+				continue;
+
+			// Same item cannot pull itself
+			if (pulling_item.item == i->type)
+				continue;
+
+			const ItemType &pullable_item = ItemDefs[i->type];
+
+			int pulling_items = items.GetNum(pulling_item.item);  // horse, camel, etc
+			int pullable_items = i->num;  // wagon, etc
+
+			int used_pulling_items = 0;
+			if (used_items.find(pulling_item.item) != used_items.end())
+				used_pulling_items = used_items[pulling_item.item];
+
+			int used_pullable_items = 0;
+			if (used_items.find(pullable_item.index) != used_items.end())
+				used_pullable_items = used_items[pullable_item.index];
+
+			// Subtract already used pulling items
+			pulling_items -= used_pulling_items;
+			if (pulling_items <= 0)
+				continue;
+
+			// More pulling items than needed, leave the rest for other pullables
+			if (pulling_items > pullable_items)
+				pulling_items = pullable_items;
+
+			// Subtract already used pullable items
+			pullable_items -= used_pullable_items;
+			if (pullable_items <= 0)
+				continue;
+
+			// Not enough pulling items, less pullables will be used
+			if (pullable_items > pulling_items)
+				pullable_items = pulling_items;
+
+			cap += pullable_items * pulling_item.walk;  // pulling_item.walk is wagon bonus walk capacity
+
+			// Update the used item values
+			used_items[pulling_item.item] = pulling_items + used_pulling_items;
+			used_items[pullable_item.index] = pullable_items + used_pullable_items;
+		}
+	}
+
+	return cap;
+}
+
+///@return tactics of 'u', or of its best monster
+static int TacticsOf(Unit &u)
+{
+	int retval = u.GetRealSkill(S_TACTICS);
+
+	forlist(&u.items)
+	{
+		Item *i = (Item*)elem;
+		if (ItemDefs[i->type].type & IT_MONSTER)
+		{
+			const int temp = MonDefs[(ItemDefs[i->type].index)].tactics;
+			if (temp > retval)
+				retval = temp;
+		}
+	}
+
+	return retval;
+}
+
+///@return observation of 'u', or of its best monster
+static int ObservationOf(Unit &u)
+{
+	// pull observation skill, with bonuses
+	int retval = u.GetRealSkill(S_OBSERVATION) + u.GetSkillBonus(S_OBSERVATION);
+
+	// max against any integrated monsters with OBS
+	forlist(&u.items)
+	{
+		Item *i = (Item*)elem;
+
+		if (ItemDefs[i->type].type & IT_MONSTER)
+		{
+			const int temp = MonDefs[ItemDefs[i->type].index].obs;
+			if (temp > retval)
+				retval = temp;
+		}
+	}
+
+	return retval;
+}
+
+///@return stealth bonus of 'u', keeping invisible if 'invis'
+static int StealthBonus(Unit &u, bool invis)
+{
+	const int men = u.GetMen();
+	int bonus = 0;
+
+	if (men == 1 && Globals->FULL_INVIS_ON_SELF)
+	{
+		bonus = u.GetSkill(S_INVISIBILITY);
+	}
+
+	if (bonus < 3 &&
+	    (invis || men <= u.items.GetNum(I_RINGOFI)))
+	{
+		bonus = 3;
+	}
+
+	return bonus;
+}
+
+///@return stealth of 'u' when not on guard, keeping invisible if 'invis'
+static int StealthOf(Unit &u, bool invis)
+{
+	int monstealth = 100; // lowest monster stealth
+	int manstealth = 100; // stealth skill (if any men)
+
+	//foreach item in unit
+	forlist(&u.items)
+	{
+		Item *i = (Item*)elem;
+		if (ItemDefs[i->type].type & IT_MONSTER)
+		{
+			const int temp = MonDefs[ItemDefs[i->type].index].stealth;
+			if (temp < monstealth) monstealth = temp;
+		}
+		else if (ItemDefs[i->type].type & IT_MAN)
+		{
+			if (manstealth == 100)
+				manstealth = u.GetRealSkill(S_STEALTH);
+		}
+	}
+
+	manstealth += StealthBonus(u, invis);
+
+	// return min
+	if (monstealth < manstealth)
+		return monstealth;
+
+	return manstealth;
+}
+
+int Unit::workOut(UnitStat s)
+{
+	switch (s)
+	{
+		case US_MEN:           return CountOf(items, IT_MAN);
+		case US_WEIGHT:        return items.Weight();
+		case US_FLY:           return CapacityOf(items, &ItemType::fly);
+		case US_RIDE:          return CapacityOf(items, &ItemType::ride);
+		case US_SWIM:          return CapacityOf(items, &ItemType::swim);
+		case US_WALK:          return WalkingCapacityOf(items);
+		case US_TACTICS:       return TacticsOf(*this);
+		case US_OBSERVATION:   return ObservationOf(*this);
+		case US_STEALTH:       return StealthOf(*this, false);
+		case US_STEALTH_INVIS: return StealthOf(*this, true);
+		case US_NUM:           break;
+	}
+	return 0;
+}
+
+int Unit::stat(UnitStat s)
+{
+	// forget everything once items or skills change
+	if (statItems_ != items.Version() || statSkills_ != skills.Version())
+	{
+		statKnown_ = 0;
+		statItems_ = items.Version();
+		statSkills_ = skills.Version();
+	}
+
+	const unsigned bit = 1u << s;
+	if (!(statKnown_ & bit))
+	{
+		stats_[s] = workOut(s);
+		statKnown_ |= bit;
+	}
+	else if (Globals->CHECK_UNIT_STATS)
+	{
+		const int fresh = workOut(s);
+		if (fresh != stats_[s])
+		{
+			std::cerr << "Unit " << num << ": cached stat " << s << " is "
+			          << stats_[s] << " but should be " << fresh << std::endl;
+			exit(1);
+		}
+	}
+
+	return stats_[s];
+}
+
+void Unit::FillStats()
+{
+	for (int s = 0; s < US_NUM; ++s)
+		stat(UnitStat(s));
+}
+
+int Unit::GetMons()
 {
 	int n = 0;
 	forlist(&items)
 	{
 		const Item *i = (const Item*)elem;
 
-		if (ItemDefs[i->type].type & IT_MAN)
+		if (ItemDefs[i->type].type & IT_MONSTER)
 			n += i->num;
 	}
 
 	return n;
 }
 
+int Unit::GetMen(int t)
+{
+	return items.GetNum(t);
+}
+
+int Unit::GetMen()
+{
+	return stat(US_MEN);
+}
+
 int Unit::GetSoldiers()
 {
 	int n = 0;
@@ -1157,41 +1391,12 @@ void Unit::consume(int itemId, int num)
 
 int Unit::GetTactics()
 {
-	int retval = GetRealSkill(S_TACTICS);
-
-	forlist(&items)
-	{
-		Item *i = (Item*)elem;
-		if (ItemDefs[i->type].type & IT_MONSTER)
-		{
-			const int temp = MonDefs[(ItemDefs[i->type].index)].tactics;
-			if (temp > retval)
-				retval = temp;
-		}
-	}
-
-	return retval;
+	return stat(US_TACTICS);
 }
 
 int Unit::GetObservation()
 {
-	// pull observation skill, with bonuses
-	int retval = GetRealSkill(S_OBSERVATION) + GetSkillBonus(S_OBSERVATION);
-
-	// max against any integrated monsters with OBS
-	forlist(&items)
-	{
-		Item *i = (Item*)elem;
-
-		if (ItemDefs[i->type].type & IT_MONSTER)
-		{
-			const int temp = MonDefs[ItemDefs[i->type].index].obs;
-			if (temp > retval)
-				retval = temp;
-		}
-	}
-
-	return retval;
+	return stat(US_OBSERVATION);
 }
 
 int Unit::GetAttackRiding()
@@ -1281,32 +1486,7 @@ int Unit::GetStealth()
 	if (guard == GUARD_GUARD)
 		return 0;
 
-	int monstealth = 100; // lowest monster stealth
-	int manstealth = 100; // stealth skill (if any men)
-
-	//foreach item in unit
-	forlist(&items)
-	{
-		Item *i = (Item*)elem;
-		if (ItemDefs[i->type].type & IT_MONSTER)
-		{
-			const int temp = MonDefs[ItemDefs[i->type].index].stealth;
-			if (temp < monstealth) monstealth = temp;
-		}
-		else if (ItemDefs[i->type].type & IT_MAN)
-		{
-			if (manstealth == 100)
-				manstealth = GetRealSkill(S_STEALTH);
-		}
-	}
-
-	manstealth += GetSkillBonus(S_STEALTH);
-
-	// return min
-	if (monstealth < manstealth)
-		return monstealth;
-
-	return manstealth;
+	return stat(GetFlag(FLAG_INVIS) ? US_STEALTH_INVIS : US_STEALTH);
 }
 
 int Unit::GetEntertainment()
@@ -1604,10 +1784,7 @@ void Unit::limitSkillNoMagic()
 		{
 			Skill *s = (Skill*)elem;
 			if (s != maxskill)
-			{
-				skills.Remove(s);
-				delete s;
-			}
+				skills.SetDays(s->type, 0);
 		}
 	}
 }
@@ -1641,8 +1818,7 @@ void Unit::limitSkillMagic(unsigned max_no_magic)
 			if (int(s->days) <= nomagic_skill_max)
 			{
 				--num_no_magic;
-				skills.Remove(s);
-				delete s;
+				skills.SetDays(s->type, 0);
 			}
 
 			if (num_no_magic <= max_no_magic)
@@ -1670,6 +1846,7 @@ void Unit::AdjustSkills()
 			{
 				s->days = GetDaysByLevel(::SkillMax(s->type, I_LEADERS)) *
 					GetMen();
+				skills.Touched();
 			}
 		}
 
@@ -1713,6 +1890,7 @@ void Unit::AdjustSkills()
 		if (GetRealSkill(theskill->type) >= max)
 		{
 			theskill->days = GetDaysByLevel(max) * GetMen();
+			skills.Touched();
 		}
 	}
 }
@@ -1943,109 +2121,27 @@ void Unit::Short(int needed, int hunger)
 
 int Unit::Weight()
 {
-	return items.Weight();
+	return stat(US_WEIGHT);
 }
 
 int Unit::FlyingCapacity()
 {
-	int cap = 0;
-	forlist(&items)
-	{
-		Item *i = (Item*)elem;
-		cap += ItemDefs[i->type].fly * i->num;
-	}
-
-	return cap;
+	return stat(US_FLY);
 }
 
 int Unit::RidingCapacity()
 {
-	int cap = 0;
-	forlist(&items)
-	{
-		Item *i = (Item*)elem;
-		cap += ItemDefs[i->type].ride * i->num;
-	}
-
-	return cap;
+	return stat(US_RIDE);
 }
 
 int Unit::SwimmingCapacity()
 {
-	int cap = 0;
-	forlist(&items)
-	{
-		Item *i = (Item*)elem;
-		cap += ItemDefs[i->type].swim * i->num;
-	}
-
-	return cap;
+	return stat(US_SWIM);
 }
 
 int Unit::WalkingCapacity()
 {
-	int cap = 0;
-	std::map<int, int> used_items;  // pulling/pullable itmes (e.g. horses, camels, wagon, etc)
-
-	forlist(&items)
-	{
-		Item *i = (Item*)elem;
-
-		cap += ItemDefs[i->type].walk * i->num;
-
-		// Add capacity of pullable items (wagons, etc)
-		for (unsigned c = 0; c < ItemDefs[i->type].hitchItems.size(); ++c)
-		{
-			const HitchItem &pulling_item = ItemDefs[i->type].hitchItems[c];
-
-			// No pulling item specified
-			if (pulling_item.item == -1)
-				continue;
-
-			// Same item cannot pull itself
-			if (pulling_item.item == i->type)
-				continue;
-
-			const ItemType &pullable_item = ItemDefs[i->type];
-
-			int pulling_items = items.GetNum(pulling_item.item);  // horse, camel, etc
-			int pullable_items = i->num;  // wagon, etc
-
-			int used_pulling_items = 0;
-			if (used_items.find(pulling_item.item) != used_items.end())
-				used_pulling_items = used_items[pulling_item.item];
-
-			int used_pullable_items = 0;
-			if (used_items.find(pullable_item.index) != used_items.end())
-				used_pullable_items = used_items[pullable_item.index];
-
-			// Subtract already used pulling items
-			pulling_items -= used_pulling_items;
-			if (pulling_items <= 0)
-				continue;
-
-			// More pulling items than needed, leave the rest for other pullables
-			if (pulling_items > pullable_items)
-				pulling_items = pullable_items;
-
-			// Subtract already used pullable items
-			pullable_items -= used_pullable_items;
-			if (pullable_items <= 0)
-				continue;
-
-			// Not enough pulling items, less pullables will be used
-			if (pullable_items > pulling_items)
-				pullable_items = pulling_items;
-
-			cap += pullable_items * pulling_item.walk;  // pulling_item.walk is wagon bonus walk capacity
-
-			// Update the used item values
-			used_items[pulling_item.item] = pulling_items + used_pulling_items;
-			used_items[pullable_item.index] = pullable_items + used_pullable_items;
-		}
-	}
-
-	return cap;
+	return stat(US_WALK);
 }
 
 int Unit::CanFly(int weight)
@@ -2991,16 +3087,7 @@ int Unit::GetSkillBonus(int sk)
 			break;
 
 		case S_STEALTH:
-			if (men == 1 && Globals->FULL_INVIS_ON_SELF)
-			{
-				bonus = GetSkill(S_INVISIBILITY);
-			}
-
-			if (bonus < 3 &&
-			    (GetFlag(FLAG_INVIS) || men <= items.GetNum(I_RINGOFI)))
-			{
-				bonus = 3;
-			}
+			bonus = StealthBonus(*this, GetFlag(FLAG_INVIS));
 			break;
 
 		default:;
@@ -3144,6 +3231,7 @@ void Unit::SkillStarvation()
 		Skill *s = GetSkillObject(i);
 		const int level = GetLevelByDays(s->days);
 		s->days -= level * 30;
+		skills.Touched();
 		if (level == 1)
 		{
 			if (s->days <= 0)
@@ -104,6 +104,23 @@ enum
 	FLAG_SHARE             = 0x1000  ///< share with friendly units
 };
 
+/// Values worked out from a unit's items and skills, which Unit keeps until
+/// either list changes
+enum UnitStat
+{
+	US_MEN,
+	US_WEIGHT,
+	US_FLY,
+	US_RIDE,
+	US_SWIM,
+	US_WALK,
+	US_TACTICS,
+	US_OBSERVATION,
+	US_STEALTH,       ///< not on guard, without the invisibility spell
+	US_STEALTH_INVIS, ///< not on guard, keeping invisible
+	US_NUM
+};
+
 //----------------------------------------------------------------------------
 /// Handle on a unit, including new units ('alias')
 class UnitId : public AListElem
@@ -213,6 +230,10 @@ public:
 	///@return item id of first man type
 	int firstManType();
 
+	/// work out every UnitStat now, so that later calls only read them
+	/// (until items or skills change), as report threads need
+	void FillStats();
+
 	///@return number of monsters in unit
 	int GetMons();
 
@@ -468,6 +489,19 @@ protected:
 
 	///@return movement points corresponding to MoveType()
 	int CalcMovePoints(MoveType mt);
+
+private:
+	///@return 'stat', from the cache if items and skills haven't changed
+	int stat(UnitStat stat);
+
+	///@return 'stat' worked out from scratch
+	int workOut(UnitStat stat);
+
+private:
+	unsigned statItems_ = 0;   ///< items.Version() when the cache was filled
+	unsigned statSkills_ = 0;  ///< skills.Version() when the cache was filled
+	unsigned statKnown_ = 0;   ///< bit per UnitStat held in stats_
+	int stats_[US_NUM];        ///< cached values of each UnitStat
 };
 
 //----------------------------------------------------------------------------
@@ -0,0 +1,169 @@
+// START A3HEADER
+//
+// This source file is part of the Atlantis PBM game program.
+// Copyright (C) 1995-1999 Geoff Dunbar
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program, in the file license.txt. If not, write
+// to the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+// Boston, MA 02111-1307, USA.
+//
+// See the Atlantis Project web page for details:
+// http://www.prankster.com/project
+//
+// END A3HEADER
+#include "upkeep.h"
+#include "aregion.h"
+#include "faction.h"
+#include "object.h"
+#include "unit.h"
+#include <cstdlib>
+#include <iostream>
+
+std::vector<UpkeepStock*>::const_iterator UpkeepList::begin()
+{
+	while (first_ < stocks_.size() && !stocks_[first_]->num)
+		++first_;
+	return stocks_.begin() + first_;
+}
+
+std::vector<UpkeepAllies::Entry>::const_iterator UpkeepAllies::begin()
+{
+	while (first_ < entries_.size() && !entries_[first_].stock->num)
+		++first_;
+	return entries_.begin() + first_;
+}
+
+enum
+{
+	ALLY_NEVER,
+	ALLY_ALWAYS,
+	ALLY_UNSEEN, ///< allied to units whose faction it can't see
+};
+
+///@return how units of 'holder' stand towards units of 'fac', following
+/// Unit::GetAttitude: an ALLY attitude holds whatever is seen, but a default
+/// attitude of ALLY only holds for units whose faction it can't see
+static int AllyTo(Faction *holder, const Faction *fac)
+{
+	const int att = holder->GetAttitude(fac->num);
+	if (att == A_ALLY)
+		return ALLY_ALWAYS;
+
+	if (att >= A_FRIENDLY && att >= holder->defaultattitude)
+		return ALLY_NEVER;
+
+	return (holder->defaultattitude == A_ALLY) ? ALLY_UNSEEN : ALLY_NEVER;
+}
+
+UpkeepRegion::UpkeepRegion(ARegion *r, const std::vector<int> &items)
+	: region(r), items_(items.size())
+{
+	for (unsigned i = 0; i < items.size(); ++i)
+		items_[i].item = items[i];
+
+	int object = 0;
+	forlist(&r->objects)
+	{
+		Object *obj = (Object*)elem;
+		for (auto &u : obj->getUnits())
+		{
+			units.push_back(u);
+			for (ItemStocks &s : items_)
+			{
+				const int num = u->items.GetNum(s.item);
+				if (!num)
+					continue;
+
+				UpkeepList &faction = s.factions[u->faction];
+				s.stocks.push_back({u, object, num, &s.all, &faction});
+				s.all.stocks_.push_back(&s.stocks.back());
+				s.all.total_ += num;
+				faction.stocks_.push_back(&s.stocks.back());
+				faction.total_ += num;
+			}
+		}
+		++object;
+	}
+}
+
+UpkeepRegion::ItemStocks& UpkeepRegion::find(int item)
+{
+	for (ItemStocks &s : items_)
+	{
+		if (s.item == item)
+			return s;
+	}
+	std::cerr << "UpkeepRegion: no ledger for item " << item << std::endl;
+	exit(1);
+}
+
+UpkeepList& UpkeepRegion::Stocks(int item, const Faction *fac)
+{
+	ItemStocks &s = find(item);
+	return fac ? s.factions[fac] : s.all;
+}
+
+UpkeepAllies& UpkeepRegion::Allies(int item, Faction *fac)
+{
+	ItemStocks &s = find(item);
+	auto found = s.allies.find(fac);
+	if (found != s.allies.end())
+		return found->second;
+
+	// one attitude per holding faction, rather than one per unit
+	std::unordered_map<const Faction*, int> stands;
+	UpkeepAllies &allies = s.allies[fac];
+	for (UpkeepStock *stock : s.all.stocks_)
+	{
+		Faction *holder = stock->unit->faction;
+		auto stand = stands.find(holder);
+		if (stand == stands.end())
+		{
+			const int a = (holder == fac) ? ALLY_NEVER : AllyTo(holder, fac);
+			stand = stands.emplace(holder, a).first;
+		}
+
+		if (stand->second != ALLY_NEVER && stock->num)
+			allies.entries_.push_back({stock, stand->second == ALLY_UNSEEN});
+	}
+	return allies;
+}
+
+void UpkeepRegion::Take(int item, UpkeepStock &stock, int num)
+{
+	stock.num -= num;
+	stock.all->total_ -= num;
+	stock.faction->total_ -= num;
+	stock.unit->items.SetNum(item, stock.num);
+}
+
+Upkeep::Upkeep(ARegionList &regions, const std::vector<int> &items)
+{
+	forlist(&regions)
+	{
+		ARegion *r = (ARegion*)elem;
+		// (nothing to do where there are no units)
+		bool units = false;
+		forlist(&r->objects)
+		{
+			if (!((Object*)elem)->getUnits().empty())
+			{
+				units = true;
+				break;
+			}
+		}
+		if (units)
+			this->regions.emplace_back(r, items);
+	}
+}
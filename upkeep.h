@@ -0,0 +1,141 @@
+#ifndef UPKEEP_CLASS
+#define UPKEEP_CLASS
+// START A3HEADER
+//
+// This source file is part of the Atlantis PBM game program.
+// Copyright (C) 1995-1999 Geoff Dunbar
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program, in the file license.txt. If not, write
+// to the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+// Boston, MA 02111-1307, USA.
+//
+// See the Atlantis Project web page for details:
+// http://www.prankster.com/project
+//
+// END A3HEADER
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+class ARegion;
+class ARegionList;
+class Faction;
+class Unit;
+
+class UpkeepList;
+
+//----------------------------------------------------------------------------
+/// What one unit holds of an item used for upkeep
+struct UpkeepStock
+{
+	Unit *unit;
+	int object;           ///< which object of the region the unit is in
+	int num;              ///< how many the unit has left
+	UpkeepList *all;      ///< the region's list holding this stock
+	UpkeepList *faction;  ///< the unit's faction's list holding this stock
+};
+
+//----------------------------------------------------------------------------
+/// Stocks of one item in a region, in the order the units are in the region
+class UpkeepList
+{
+public:
+	///@return the first stock, skipping those used up at the front
+	std::vector<UpkeepStock*>::const_iterator begin();
+	std::vector<UpkeepStock*>::const_iterator end() const { return stocks_.end(); }
+
+	///@return how many are left in all the stocks
+	int Total() const { return total_; }
+
+private:
+	friend class UpkeepRegion;
+
+	std::vector<UpkeepStock*> stocks_;
+	std::size_t first_ = 0;
+	int total_ = 0;
+};
+
+//----------------------------------------------------------------------------
+/// Stocks of one item in a region held by units of the other factions that
+/// may be allied to one faction, in the order the units are in the region
+class UpkeepAllies
+{
+public:
+	struct Entry
+	{
+		UpkeepStock *stock;
+		bool check; ///< allied only to units it can't see (default ALLY)
+	};
+
+	///@return the first entry, skipping those used up at the front
+	std::vector<Entry>::const_iterator begin();
+	std::vector<Entry>::const_iterator end() const { return entries_.end(); }
+
+private:
+	friend class UpkeepRegion;
+
+	std::vector<Entry> entries_;
+	std::size_t first_ = 0;
+};
+
+//----------------------------------------------------------------------------
+/// The units of one region and who holds which upkeep items, kept up to date
+/// as the items are used up (see Game::AssessMaintenance)
+class UpkeepRegion
+{
+public:
+	UpkeepRegion(ARegion *r, const std::vector<int> &items);
+	UpkeepRegion(const UpkeepRegion&) = delete;
+	UpkeepRegion& operator=(const UpkeepRegion&) = delete;
+
+	///@return the stocks of 'item' held by units of 'fac', or by every unit
+	/// if 'fac' is NULL
+	UpkeepList& Stocks(int item, const Faction *fac = nullptr);
+
+	///@return the stocks of 'item' that units of 'fac' may borrow, sorted out
+	/// by faction attitude the first time they are asked for
+	UpkeepAllies& Allies(int item, Faction *fac);
+
+	/// use up 'num' of 'item' from 'stock'
+	void Take(int item, UpkeepStock &stock, int num);
+
+	ARegion *const region;
+	std::vector<Unit*> units; ///< every unit, in region order
+
+private:
+	struct ItemStocks
+	{
+		int item;
+		std::deque<UpkeepStock> stocks;
+		UpkeepList all;
+		std::unordered_map<const Faction*, UpkeepList> factions;
+		std::unordered_map<const Faction*, UpkeepAllies> allies;
+	};
+
+	///@return the stocks of 'item'
+	ItemStocks& find(int item);
+
+	std::vector<ItemStocks> items_; ///< (never resized, as stocks point in)
+};
+
+//----------------------------------------------------------------------------
+/// Upkeep ledgers of every region, built once per turn for maintenance
+class Upkeep
+{
+public:
+	Upkeep(ARegionList &regions, const std::vector<int> &items);
+
+	std::deque<UpkeepRegion> regions; ///< those with units, in list order
+};
+#endif